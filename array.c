@@ -98,3 +98,27 @@ void initArr(unsigned int *arr, unsigned int initVal, unsigned int arrSize) {
 	int i;
 	for (i=0;i<arrSize;i++) arr[i]=initVal; /* init all arr elements to initVal */
 }
+
+/* stable sort: ind holds the indexes of key array in ascending key order, equal keys keep index order *
+ *  LSD radix sort with 8-bit digits, passes where all keys share the same digit are skipped and no    *
+ *  pass runs above the highest key bit. tmp is scratch memory of arrSize elements (the caller's arena) */
+void sortInd(unsigned long long *key, unsigned int *ind, unsigned int *tmp, unsigned int arrSize) {
+	unsigned int cnt[256];
+	unsigned int *src, *dst, *swp;
+	unsigned int i, shift, sum, dig;
+	unsigned long long any=0;
+	if (arrSize==0) return;
+	for (i=0;i<arrSize;i++) {ind[i]=i; any|=key[i];}	/* identity order, all key bits */
+	src=ind; dst=tmp;
+	for (shift=0;(shift<64)&&((any>>shift)!=0);shift+=8) {
+		for (i=0;i<256;i++) cnt[i]=0;
+		for (i=0;i<arrSize;i++) cnt[(key[src[i]]>>shift)&0xFF]++;	/* digit histogram */
+		if (cnt[(key[src[0]]>>shift)&0xFF]==arrSize) continue;	/* same digit for all keys */
+		for (sum=0,i=0;i<256;i++) {dig=cnt[i]; cnt[i]=sum; sum+=dig;}	/* bucket starts */
+		for (i=0;i<arrSize;i++) dst[cnt[(key[src[i]]>>shift)&0xFF]++]=src[i];	/* scatter */
+		swp=src; src=dst; dst=swp;						/* swap buffers */
+	}
+	if (src!=ind) {										/* result is in scratch buffer */
+		for (i=0;i<arrSize;i++) ind[i]=src[i];
+	}
+}
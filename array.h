@@ -41,7 +41,7 @@ unsigned int minInd(unsigned int *arr, unsigned int arrSize);
 unsigned int maxInd(unsigned int *arr, unsigned int arrSize);
 
 /* returns the index of the only positive value (when all others are zero), else return UINT_MAX */
-unsigned int onePositive(unsigned int *arr, unsigned int arrSize);
+unsigned int onlyPositiveInd(unsigned int *arr, unsigned int arrSize);
 
 /* add values in first array to second array */
 void addArr(unsigned int *arr, unsigned int *acc,unsigned int arrSize);
@@ -49,4 +49,8 @@ void addArr(unsigned int *arr, unsigned int *acc,unsigned int arrSize);
 /* initialize all array elements to initVal value */
 void initArr(unsigned int *arr, unsigned int initVal, unsigned int arrSize);
 
+/* stable sort: ind holds the indexes of key array in ascending key order, equal keys keep index order *
+ * tmp is scratch memory of arrSize elements                                                          */
+void sortInd(unsigned long long *key, unsigned int *ind, unsigned int *tmp, unsigned int arrSize);
+
 #endif /* __MATRIX_HEADER__ */
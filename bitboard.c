@@ -0,0 +1,209 @@
+/***********************************************************************************
+** Copyright (c) 2011, University of British Columbia (UBC); All rights reserved. **
+**                                                                                **
+** Redistribution  and  use  in  source   and  binary  forms,   with  or  without **
+** modification,  are permitted  provided that  the following conditions are met: **
+**   * Redistributions   of  source   code  must  retain   the   above  copyright **
+**     notice,  this   list   of   conditions   and   the  following  disclaimer. **
+**   * Redistributions  in  binary  form  must  reproduce  the  above   copyright **
+**     notice, this  list  of  conditions  and the  following  disclaimer in  the **
+**     documentation and/or  other  materials  provided  with  the  distribution. **
+**   * Neither the name of the University of British Columbia (UBC) nor the names **
+**     of   its   contributors  may  be  used  to  endorse  or   promote products **
+**     derived from  this  software without  specific  prior  written permission. **
+**                                                                                **
+** THIS  SOFTWARE IS  PROVIDED  BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" **
+** AND  ANY EXPRESS  OR IMPLIED WARRANTIES,  INCLUDING,  BUT NOT LIMITED TO,  THE **
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE **
+** DISCLAIMED.  IN NO  EVENT SHALL University of British Columbia (UBC) BE LIABLE **
+** FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL **
+** DAMAGES  (INCLUDING,  BUT NOT LIMITED TO,  PROCUREMENT OF  SUBSTITUTE GOODS OR **
+** SERVICES;  LOSS OF USE,  DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER **
+** CAUSED AND ON ANY THEORY OF LIABILITY,  WHETHER IN CONTRACT, STRICT LIABILITY, **
+** OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE **
+** OF  THIS SOFTWARE,  EVEN  IF  ADVISED  OF  THE  POSSIBILITY  OF  SUCH  DAMAGE. **
+***********************************************************************************/
+
+/***********************************************************************************
+** bitboard.c: packed bit-per-tile grid module (64 tiles per word)                **
+**                                                                                **
+**    Author: Ameer M. Abdelhadi (ameer@ece.ubc.ca, ameer.abdelhadi@gmail.com)    **
+**                University of British Columbia (UBC), Feb. 2011                 **
+***********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitboard.h"
+#include "common.h"
+
+/* returns a new all-zero bitboard, size colXrow */
+bb *bbCreate(unsigned int col, unsigned int row) {
+	bb *b = (bb*)safeMalloc(sizeof(bb));
+	b->col   = col;
+	b->row   = row;
+	b->words = (col+63)/64;
+	b->pitch = b->words+2;
+	b->bits  = (bbWord*)safeCalloc(sizeof(bbWord)*b->pitch*(row+2)); /* pages are committed as rows are set */
+	return b;
+}
+
+/* free a bitboard */
+void bbDelete(bb *b) {
+	safeFree(b->bits);
+	safeFree(b);
+}
+
+/* clear rows iRow0 to iRow1 (inclusive) */
+void bbClearRows(bb *b, unsigned int iRow0, unsigned int iRow1) {
+	if (iRow0 > iRow1) return;
+	memset(bbRow(b,iRow0),0,sizeof(bbWord)*((unsigned long long)b->pitch*(iRow1-iRow0)+b->words));
+}
+
+/* dilate one row: n = (cur and its four neighbors) & p & ~v, v |= n   *
+ * cur[-1] and cur[words] are read, they are guard words (kept zero)  *
+ * returns OR of all words of n                                       */
+static bbWord bbDilateRowScalar(bbWord *n, bbWord *p, bbWord *v, bbWord *up, bbWord *cur, bbWord *down,
+                                unsigned int w, unsigned int words) {
+	bbWord *left=cur-1, *right=cur+1; /* word to the left/right, guard words at row ends */
+	bbWord dil, any=0;
+	for (;w<words;w++) {
+		dil = cur[w] | up[w] | down[w]
+		    | (cur[w]<<1) | (left[w] >>63)  /* from left neighbor  */
+		    | (cur[w]>>1) | (right[w]<<63); /* from right neighbor */
+		n[w]  = dil & p[w] & ~v[w];
+		v[w] |= n[w];
+		any  |= n[w];
+	}
+	return any;
+}
+
+/* x86 vector kernels, selected at run time; build with -DBB_SCALAR to use the scalar kernel only */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(BB_SCALAR)
+#define BB_X86_KERNELS
+#include <immintrin.h>
+
+/* AVX2 version of bbDilateRowScalar, 4 words per step; bits crossing a word boundary *
+ * are taken from unaligned loads of the words to the left and right                  */
+__attribute__((target("avx2")))
+static bbWord bbDilateRowAVX2(bbWord *n, bbWord *p, bbWord *v, bbWord *up, bbWord *cur, bbWord *down,
+                              unsigned int w, unsigned int words) {
+	__m256i c, dil, nw, acc=_mm256_setzero_si256();
+	bbWord any[4];
+	for (;w+4<=words;w+=4) {
+		c   = _mm256_loadu_si256((__m256i*)(cur+w));
+		dil = _mm256_or_si256(c,_mm256_or_si256(_mm256_loadu_si256((__m256i*)(up+w)),_mm256_loadu_si256((__m256i*)(down+w))));
+		dil = _mm256_or_si256(dil,_mm256_or_si256(_mm256_slli_epi64(c,1),_mm256_srli_epi64(_mm256_loadu_si256((__m256i*)(cur+w-1)),63)));
+		dil = _mm256_or_si256(dil,_mm256_or_si256(_mm256_srli_epi64(c,1),_mm256_slli_epi64(_mm256_loadu_si256((__m256i*)(cur+w+1)),63)));
+		nw  = _mm256_andnot_si256(_mm256_loadu_si256((__m256i*)(v+w)),_mm256_and_si256(dil,_mm256_loadu_si256((__m256i*)(p+w))));
+		_mm256_storeu_si256((__m256i*)(n+w),nw);
+		_mm256_storeu_si256((__m256i*)(v+w),_mm256_or_si256(_mm256_loadu_si256((__m256i*)(v+w)),nw));
+		acc = _mm256_or_si256(acc,nw);
+	}
+	_mm256_storeu_si256((__m256i*)any,acc);
+	return any[0] | any[1] | any[2] | any[3] | bbDilateRowScalar(n,p,v,up,cur,down,w,words);
+}
+
+/* AVX-512 version of bbDilateRowScalar, 8 words per step */
+__attribute__((target("avx512f")))
+static bbWord bbDilateRowAVX512(bbWord *n, bbWord *p, bbWord *v, bbWord *up, bbWord *cur, bbWord *down,
+                                unsigned int w, unsigned int words) {
+	__m512i c, dil, nw, acc=_mm512_setzero_si512();
+	for (;w+8<=words;w+=8) {
+		c   = _mm512_loadu_si512(cur+w);
+		dil = _mm512_or_si512(c,_mm512_or_si512(_mm512_loadu_si512(up+w),_mm512_loadu_si512(down+w)));
+		dil = _mm512_or_si512(dil,_mm512_or_si512(_mm512_slli_epi64(c,1),_mm512_srli_epi64(_mm512_loadu_si512(cur+w-1),63)));
+		dil = _mm512_or_si512(dil,_mm512_or_si512(_mm512_srli_epi64(c,1),_mm512_slli_epi64(_mm512_loadu_si512(cur+w+1),63)));
+		nw  = _mm512_andnot_si512(_mm512_loadu_si512(v+w),_mm512_and_si512(dil,_mm512_loadu_si512(p+w)));
+		_mm512_storeu_si512(n+w,nw);
+		_mm512_storeu_si512(v+w,_mm512_or_si512(_mm512_loadu_si512(v+w),nw));
+		acc = _mm512_or_si512(acc,nw);
+	}
+	return (bbWord)_mm512_reduce_or_epi64(acc) | bbDilateRowScalar(n,p,v,up,cur,down,w,words);
+}
+#endif
+
+/* row dilation kernel, selected by bbKernel on first use */
+static bbWord (*bbDilateRow)(bbWord*, bbWord*, bbWord*, bbWord*, bbWord*, bbWord*, unsigned int, unsigned int) = NULL;
+static const char *bbKernelName = "scalar";
+
+/* select row dilation kernel by CPU support: avx512, avx2 or scalar. returns kernel name */
+const char *bbKernel() {
+	if (bbDilateRow != NULL) return bbKernelName;
+	bbDilateRow  = bbDilateRowScalar;
+	bbKernelName = "scalar";
+#ifdef BB_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		bbDilateRow  = bbDilateRowAVX512;
+		bbKernelName = "avx512";
+	} else if (__builtin_cpu_supports("avx2")) {
+		bbDilateRow  = bbDilateRowAVX2;
+		bbKernelName = "avx2";
+	}
+#endif
+	return bbKernelName;
+}
+
+/* one wave step on rows iRow0 to iRow1 and columns iCol0 to iCol1 (inclusive) of next: *
+ * next = (front and its four neighbors) & pass & ~visit, then visit |= next          *
+ * front rows iRow0-1 to iRow1+1 are read, they must be inside the grid or zero guard *
+ * rows. bits of next out of the columns are left as they are (zero if front is kept  *
+ * inside them). returns 1 if any bit is set in next, 0 otherwise                     */
+int bbDilate(bb *next, bb *front, bb *pass, bb *visit, unsigned int iRow0, unsigned int iRow1,
+             unsigned int iCol0, unsigned int iCol1) {
+	unsigned int iRow, w, w0=iCol0>>6, w1=iCol1>>6;
+	bbWord lo=(1ULL<<(iCol0&63))-1;                             /* bits left of iCol0 in word w0  */
+	bbWord hi=((iCol1&63) < 63) ? ~((2ULL<<(iCol1&63))-1) : 0; /* bits right of iCol1 in word w1 */
+	bbWord *cur, *n, *v, rowAny, any=0;
+	if (bbDilateRow == NULL) bbKernel();
+	for (iRow=iRow0;iRow<=iRow1;iRow++) {
+		cur    = bbRow(front,iRow);
+		n      = bbRow(next ,iRow);
+		v      = bbRow(visit,iRow);
+		rowAny = bbDilateRow(n,bbRow(pass,iRow),v,cur-front->pitch,cur,cur+front->pitch,w0,w1+1);
+		if (lo | hi) { /* drop bits out of the columns from the edge words */
+			v[w0] &= ~(n[w0] & lo); n[w0] &= ~lo;
+			v[w1] &= ~(n[w1] & hi); n[w1] &= ~hi;
+			for (rowAny=0,w=w0;w<=w1;w++) rowAny |= n[w];
+		}
+		any |= rowAny;
+	}
+	return (any != 0);
+}
+
+/* find first set bit of front in row-major order (rows iRow0 to iRow1) that has *
+ * a four-neighbor set in tgt. returns 1 if found at (*iCol,*iRow), 0 otherwise  */
+int bbFirstTouch(bb *front, bb *tgt, unsigned int iRow0, unsigned int iRow1,
+                 unsigned int *iCol, unsigned int *iRow) {
+	unsigned int r, w, words=front->words;
+	bbWord *t, *f, *up, *down, *left, *right;
+	bbWord touch;
+	for (r=iRow0;r<=iRow1;r++) {
+		t     = bbRow(tgt  ,r);
+		f     = bbRow(front,r);
+		up    = t - tgt->pitch;
+		down  = t + tgt->pitch;
+		left  = t - 1;
+		right = t + 1;
+		for (w=0;w<words;w++) {
+			touch = f[w] & ( up[w] | down[w]
+			               | (t[w]<<1) | (left[w]>>63) | (t[w]>>1) | (right[w]<<63) );
+			if (touch) {
+				*iCol = w*64 + __builtin_ctzll(touch);
+				*iRow = r;
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/* clear all bits of rows iRow0 to iRow1 (inclusive) that come after tile (iCol,iRow) in row-major order */
+void bbClearAfter(bb *b, unsigned int iCol, unsigned int iRow, unsigned int iRow1) {
+	bbWord *r = bbRow(b,iRow);
+	unsigned int w = iCol>>6;
+	if ((iCol&63) < 63) r[w] &= (2ULL<<(iCol&63))-1; /* keep bits up to iCol */
+	for (w++;w<b->words;w++) r[w]=0;
+	if (iRow < iRow1) bbClearRows(b,iRow+1,iRow1);
+}
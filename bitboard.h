@@ -0,0 +1,101 @@
+/***********************************************************************************
+** Copyright (c) 2011, University of British Columbia (UBC); All rights reserved. **
+**                                                                                **
+** Redistribution  and  use  in  source   and  binary  forms,   with  or  without **
+** modification,  are permitted  provided that  the following conditions are met: **
+**   * Redistributions   of  source   code  must  retain   the   above  copyright **
+**     notice,  this   list   of   conditions   and   the  following  disclaimer. **
+**   * Redistributions  in  binary  form  must  reproduce  the  above   copyright **
+**     notice, this  list  of  conditions  and the  following  disclaimer in  the **
+**     documentation and/or  other  materials  provided  with  the  distribution. **
+**   * Neither the name of the University of British Columbia (UBC) nor the names **
+**     of   its   contributors  may  be  used  to  endorse  or   promote products **
+**     derived from  this  software without  specific  prior  written permission. **
+**                                                                                **
+** THIS  SOFTWARE IS  PROVIDED  BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" **
+** AND  ANY EXPRESS  OR IMPLIED WARRANTIES,  INCLUDING,  BUT NOT LIMITED TO,  THE **
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE **
+** DISCLAIMED.  IN NO  EVENT SHALL University of British Columbia (UBC) BE LIABLE **
+** FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL **
+** DAMAGES  (INCLUDING,  BUT NOT LIMITED TO,  PROCUREMENT OF  SUBSTITUTE GOODS OR **
+** SERVICES;  LOSS OF USE,  DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER **
+** CAUSED AND ON ANY THEORY OF LIABILITY,  WHETHER IN CONTRACT, STRICT LIABILITY, **
+** OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE **
+** OF  THIS SOFTWARE,  EVEN  IF  ADVISED  OF  THE  POSSIBILITY  OF  SUCH  DAMAGE. **
+***********************************************************************************/
+
+/***********************************************************************************
+** bitboard.h: packed bit-per-tile grid module (64 tiles per word)                **
+**                                                                                **
+**    Author: Ameer M. Abdelhadi (ameer@ece.ubc.ca, ameer.abdelhadi@gmail.com)    **
+**                University of British Columbia (UBC), Feb. 2011                 **
+***********************************************************************************/
+
+#ifndef __BITBOARD_HEADER__
+#define __BITBOARD_HEADER__
+
+typedef unsigned long long bbWord;	/* 64 tiles per word */
+
+/* bitboard structure: one bit per grid tile, rows are padded with one zero guard word  *
+ * on each side and the grid is padded with one zero guard row above and below, hence   *
+ * neighbors of any tile can be read without boundary checks                            */
+struct bbStr {
+	unsigned int  col;   /* number of columns (bits per row)               */
+	unsigned int  row;   /* number of rows                                 */
+	unsigned int  words; /* number of data words per row                   */
+	unsigned int  pitch; /* words per row including the two guard words    */
+	bbWord       *bits;  /* (row+2)*pitch words, guard words are kept zero */
+};
+
+typedef struct bbStr bb;
+
+/* returns a new all-zero bitboard, size colXrow */
+bb *bbCreate(unsigned int col, unsigned int row);
+
+/* free a bitboard */
+void bbDelete(bb *b);
+
+/* returns a pointer to the first data word of row iRow */
+static inline bbWord *bbRow(bb *b, unsigned int iRow) {
+	return b->bits + (unsigned long long)(iRow+1)*b->pitch + 1;
+}
+
+/* set bit of tile (iCol,iRow) */
+static inline void bbSet(bb *b, unsigned int iCol, unsigned int iRow) {
+	bbRow(b,iRow)[iCol>>6] |= 1ULL<<(iCol&63);
+}
+
+/* clear bit of tile (iCol,iRow) */
+static inline void bbClr(bb *b, unsigned int iCol, unsigned int iRow) {
+	bbRow(b,iRow)[iCol>>6] &= ~(1ULL<<(iCol&63));
+}
+
+/* test bit of tile (iCol,iRow) */
+static inline int bbTest(bb *b, unsigned int iCol, unsigned int iRow) {
+	return (bbRow(b,iRow)[iCol>>6] >> (iCol&63)) & 1;
+}
+
+/* clear rows iRow0 to iRow1 (inclusive) */
+void bbClearRows(bb *b, unsigned int iRow0, unsigned int iRow1);
+
+/* select the wave step kernel by CPU support (avx512, avx2 or scalar), *
+ * done on first bbDilate if not called before. returns kernel name     */
+const char *bbKernel();
+
+/* one wave step on rows iRow0 to iRow1 and columns iCol0 to iCol1 (inclusive) of next: *
+ * next = (front and its four neighbors) & pass & ~visit, then visit |= next          *
+ * front rows iRow0-1 to iRow1+1 are read, they must be inside the grid or zero guard *
+ * rows. bits of next out of the columns are left as they are (zero if front is kept  *
+ * inside them). returns 1 if any bit is set in next, 0 otherwise                     */
+int bbDilate(bb *next, bb *front, bb *pass, bb *visit, unsigned int iRow0, unsigned int iRow1,
+             unsigned int iCol0, unsigned int iCol1);
+
+/* find first set bit of front in row-major order (rows iRow0 to iRow1) that has *
+ * a four-neighbor set in tgt. returns 1 if found at (*iCol,*iRow), 0 otherwise  */
+int bbFirstTouch(bb *front, bb *tgt, unsigned int iRow0, unsigned int iRow1,
+                 unsigned int *iCol, unsigned int *iRow);
+
+/* clear all bits of rows iRow0 to iRow1 (inclusive) that come after tile (iCol,iRow) in row-major order */
+void bbClearAfter(bb *b, unsigned int iCol, unsigned int iRow, unsigned int iRow1);
+
+#endif /* __BITBOARD_HEADER__ */
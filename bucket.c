@@ -0,0 +1,116 @@
+/***********************************************************************************
+** Copyright (c) 2011, University of British Columbia (UBC); All rights reserved. **
+**                                                                                **
+** Redistribution  and  use  in  source   and  binary  forms,   with  or  without **
+** modification,  are permitted  provided that  the following conditions are met: **
+**   * Redistributions   of  source   code  must  retain   the   above  copyright **
+**     notice,  this   list   of   conditions   and   the  following  disclaimer. **
+**   * Redistributions  in  binary  form  must  reproduce  the  above   copyright **
+**     notice, this  list  of  conditions  and the  following  disclaimer in  the **
+**     documentation and/or  other  materials  provided  with  the  distribution. **
+**   * Neither the name of the University of British Columbia (UBC) nor the names **
+**     of   its   contributors  may  be  used  to  endorse  or   promote products **
+**     derived from  this  software without  specific  prior  written permission. **
+**                                                                                **
+** THIS  SOFTWARE IS  PROVIDED  BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" **
+** AND  ANY EXPRESS  OR IMPLIED WARRANTIES,  INCLUDING,  BUT NOT LIMITED TO,  THE **
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE **
+** DISCLAIMED.  IN NO  EVENT SHALL University of British Columbia (UBC) BE LIABLE **
+** FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL **
+** DAMAGES  (INCLUDING,  BUT NOT LIMITED TO,  PROCUREMENT OF  SUBSTITUTE GOODS OR **
+** SERVICES;  LOSS OF USE,  DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER **
+** CAUSED AND ON ANY THEORY OF LIABILITY,  WHETHER IN CONTRACT, STRICT LIABILITY, **
+** OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE **
+** OF  THIS SOFTWARE,  EVEN  IF  ADVISED  OF  THE  POSSIBILITY  OF  SUCH  DAMAGE. **
+***********************************************************************************/
+
+/***********************************************************************************
+** bucket.c: bucket priority queue module for small integer keys                  **
+**                                                                                **
+**    Author: Ameer M. Abdelhadi (ameer@ece.ubc.ca, ameer.abdelhadi@gmail.com)    **
+**                University of British Columbia (UBC), Feb. 2011                 **
+***********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "bucket.h"
+#include "common.h"
+
+/* returns a new empty bucket queue */
+bq *bqCreate() {
+	bq *q = (bq*)safeMalloc(sizeof(bq));
+	q->keyCap   = 64;
+	q->head     = (gridInd*)safeMalloc(sizeof(gridInd)*q->keyCap);
+	q->nodeCap  = 1024;
+	q->nodeInd  = (gridInd*)safeMalloc(sizeof(gridInd)*q->nodeCap);
+	q->nodeVal  = (unsigned int*)safeMalloc(sizeof(unsigned int)*q->nodeCap);
+	q->nodeNext = (gridInd*)safeMalloc(sizeof(gridInd)*q->nodeCap);
+	q->maxKey   = q->keyCap-1;
+	bqClear(q);
+	return q;
+}
+
+/* free a bucket queue */
+void bqDelete(bq *q) {
+	safeFree(q->head);
+	safeFree(q->nodeInd);
+	safeFree(q->nodeVal);
+	safeFree(q->nodeNext);
+	safeFree(q);
+}
+
+/* remove all nodes */
+void bqClear(bq *q) {
+	unsigned int key;
+	for (key=0;key<=q->maxKey;key++) q->head[key] = BQ_NIL; /* only buckets used since last clear */
+	q->minKey  = 0;
+	q->maxKey  = 0;
+	q->nodeNum = 0;
+	q->size    = 0;
+}
+
+/* push node (ind,val) with key */
+void bqPush(bq *q, unsigned int key, gridInd ind, unsigned int val) {
+	gridInd node;
+	if (key >= q->keyCap) {		/* grow buckets */
+		node = q->keyCap;
+		while (q->keyCap <= key) q->keyCap *= 2;
+		q->head = (gridInd*)safeRealloc(q->head,sizeof(gridInd)*q->keyCap);
+		for (;node<q->keyCap;node++) q->head[node] = BQ_NIL;
+	}
+	if (q->nodeNum == q->nodeCap) {	/* grow node pool */
+		q->nodeCap *= 2;
+		q->nodeInd  = (gridInd*)safeRealloc(q->nodeInd ,sizeof(gridInd)*q->nodeCap);
+		q->nodeVal  = (unsigned int*)safeRealloc(q->nodeVal ,sizeof(unsigned int)*q->nodeCap);
+		q->nodeNext = (gridInd*)safeRealloc(q->nodeNext,sizeof(gridInd)*q->nodeCap);
+	}
+	node = q->nodeNum++;
+	q->nodeInd [node] = ind;
+	q->nodeVal [node] = val;
+	q->nodeNext[node] = q->head[key];
+	q->head[key] = node;
+	if ((q->size == 0) || (key < q->minKey)) q->minKey = key;
+	q->maxKey = MAX(q->maxKey,key);
+	q->size++;
+}
+
+/* smallest key in queue, UINT_MAX if queue is empty */
+unsigned int bqMinKey(bq *q) {
+	if (q->size == 0) return UINT_MAX;
+	while (q->head[q->minKey] == BQ_NIL) q->minKey++;
+	return q->minKey;
+}
+
+/* pop a node with the smallest key. returns 0 if queue is empty, 1 otherwise with (*key,*ind,*val) */
+int bqPop(bq *q, unsigned int *key, gridInd *ind, unsigned int *val) {
+	gridInd node;
+	if (q->size == 0) return 0;
+	*key = bqMinKey(q);
+	node = q->head[*key];
+	q->head[*key] = q->nodeNext[node];
+	*ind = q->nodeInd[node];
+	*val = q->nodeVal[node];
+	q->size--;
+	return 1;
+}
@@ -0,0 +1,77 @@
+/***********************************************************************************
+** Copyright (c) 2011, University of British Columbia (UBC); All rights reserved. **
+**                                                                                **
+** Redistribution  and  use  in  source   and  binary  forms,   with  or  without **
+** modification,  are permitted  provided that  the following conditions are met: **
+**   * Redistributions   of  source   code  must  retain   the   above  copyright **
+**     notice,  this   list   of   conditions   and   the  following  disclaimer. **
+**   * Redistributions  in  binary  form  must  reproduce  the  above   copyright **
+**     notice, this  list  of  conditions  and the  following  disclaimer in  the **
+**     documentation and/or  other  materials  provided  with  the  distribution. **
+**   * Neither the name of the University of British Columbia (UBC) nor the names **
+**     of   its   contributors  may  be  used  to  endorse  or   promote products **
+**     derived from  this  software without  specific  prior  written permission. **
+**                                                                                **
+** THIS  SOFTWARE IS  PROVIDED  BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" **
+** AND  ANY EXPRESS  OR IMPLIED WARRANTIES,  INCLUDING,  BUT NOT LIMITED TO,  THE **
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE **
+** DISCLAIMED.  IN NO  EVENT SHALL University of British Columbia (UBC) BE LIABLE **
+** FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL **
+** DAMAGES  (INCLUDING,  BUT NOT LIMITED TO,  PROCUREMENT OF  SUBSTITUTE GOODS OR **
+** SERVICES;  LOSS OF USE,  DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER **
+** CAUSED AND ON ANY THEORY OF LIABILITY,  WHETHER IN CONTRACT, STRICT LIABILITY, **
+** OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE **
+** OF  THIS SOFTWARE,  EVEN  IF  ADVISED  OF  THE  POSSIBILITY  OF  SUCH  DAMAGE. **
+***********************************************************************************/
+
+/***********************************************************************************
+** bucket.h: bucket priority queue module for small integer keys                  **
+**                                                                                **
+**    Author: Ameer M. Abdelhadi (ameer@ece.ubc.ca, ameer.abdelhadi@gmail.com)    **
+**                University of British Columbia (UBC), Feb. 2011                 **
+***********************************************************************************/
+
+#ifndef __BUCKET_HEADER__
+#define __BUCKET_HEADER__
+
+#include "common.h"
+
+#define BQ_NIL GRID_NONE /* end of bucket list */
+
+/* bucket queue: one linked list of nodes per key, nodes come from a pool that is  *
+ * reset by bqClear. keys are small integers (wave values), buckets grow on demand *
+ * and a pop returns the most recently pushed node of the smallest key             */
+struct bqStr {
+	gridInd      *head;     /* first node of each bucket (key), BQ_NIL if empty */
+	unsigned int  keyCap;   /* number of allocated buckets                      */
+	unsigned int  minKey;   /* all buckets below minKey are empty               */
+	unsigned int  maxKey;   /* largest key pushed since the last bqClear        */
+	gridInd      *nodeInd;  /* node payload: grid index                         */
+	unsigned int *nodeVal;  /* node payload: wave value                         */
+	gridInd      *nodeNext; /* next node in the same bucket                     */
+	gridInd       nodeNum;  /* number of used nodes in the pool                 */
+	gridInd       nodeCap;  /* number of allocated nodes                        */
+	gridInd       size;     /* number of nodes in queue                         */
+};
+
+typedef struct bqStr bq;
+
+/* returns a new empty bucket queue */
+bq  *bqCreate();
+
+/* free a bucket queue */
+void bqDelete(bq *q);
+
+/* remove all nodes */
+void bqClear(bq *q);
+
+/* push node (ind,val) with key */
+void bqPush(bq *q, unsigned int key, gridInd ind, unsigned int val);
+
+/* pop a node with the smallest key. returns 0 if queue is empty, 1 otherwise with (*key,*ind,*val) */
+int  bqPop(bq *q, unsigned int *key, gridInd *ind, unsigned int *val);
+
+/* smallest key in queue, UINT_MAX if queue is empty */
+unsigned int bqMinKey(bq *q);
+
+#endif /* __BUCKET_HEADER__ */
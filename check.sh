@@ -0,0 +1,115 @@
+#!/bin/sh
+#############################################################################################
+##     Copyright (c) 2011, University of British Columbia (UBC); All rights reserved.      ##
+##                                                                                         ##
+##     Redistribution  and  use  in  source   and  binary  forms,   with  or  without      ##
+##     modification,  are permitted  provided that  the following conditions are met:      ##
+##       * Redistributions   of  source   code  must  retain   the   above  copyright      ##
+##         notice,  this   list   of   conditions   and   the  following  disclaimer.      ##
+##       * Redistributions  in  binary  form  must  reproduce  the  above   copyright      ##
+##         notice, this  list  of  conditions  and the  following  disclaimer in  the      ##
+##         documentation and/or  other  materials  provided  with  the  distribution.      ##
+##       * Neither the name of the University of British Columbia (UBC) nor the names      ##
+##         of   its   contributors  may  be  used  to  endorse  or   promote products      ##
+##         derived from  this  software without  specific  prior  written permission.      ##
+##                                                                                         ##
+##     THIS  SOFTWARE IS  PROVIDED  BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"      ##
+##     AND  ANY EXPRESS  OR IMPLIED WARRANTIES,  INCLUDING,  BUT NOT LIMITED TO,  THE      ##
+##     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE      ##
+##     DISCLAIMED.  IN NO  EVENT SHALL University of British Columbia (UBC) BE LIABLE      ##
+##     FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL      ##
+##     DAMAGES  (INCLUDING,  BUT NOT LIMITED TO,  PROCUREMENT OF  SUBSTITUTE GOODS OR      ##
+##     SERVICES;  LOSS OF USE,  DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER      ##
+##     CAUSED AND ON ANY THEORY OF LIABILITY,  WHETHER IN CONTRACT, STRICT LIABILITY,      ##
+##     OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE      ##
+##     OF  THIS SOFTWARE,  EVEN  IF  ADVISED  OF  THE  POSSIBILITY  OF  SUCH  DAMAGE.      ##
+#############################################################################################
+
+#############################################################################################
+##   check.sh: regression checks of the multi-sink Lee-Moore shortest path maze router     ##
+##                                                                                         ##
+## usage     : sh check.sh (or 'make check'), in the source directory after 'make batch'   ##
+## engines   : maze-batch routes infiles/*.infile with wave check (-check) by each search  ##
+##             engine and option; residue labels, which -check rejects, route as the full  ##
+##             wave values do                                                              ##
+## grid      : -grid 256 floods all 65536 tiles of the empty grid                          ##
+## arena     : -verbose reports a nonzero arena high-water mark for each infile            ##
+## wide      : a 'make batch WIDE=1' build in a temporary directory routes nets at both    ##
+##             ends of a generated 100000x100000 grid (10^10 tiles), whose tile map        ##
+##             allocates the blocks around the nets only                                   ##
+## returns   : 0 if all checks pass, 1 otherwise; failed checks are reported by -E- lines  ##
+##                                                                                         ##
+##        Author: Ameer M. Abdelhadi (ameer@ece.ubc.ca, ameer.abdelhadi@gmail.com)         ##
+##                  University of British Columbia (UBC),  February 2011                   ##
+#############################################################################################
+
+FAILED=0
+TMP=`mktemp -d` || exit 1
+trap 'rm -rf $TMP' EXIT
+
+# report a failed check
+fail() {
+	echo "-E- check failed: $*"
+	FAILED=1
+}
+
+# route infile $2 by binary $1 with options $3..., output is left in $OUT.
+# returns 1 (and fails) on an -E- line or if routing does not finish
+route() {
+	bin=$1; inf=$2; shift 2
+	OUT=`$bin $inf -batch "$@" 2>&1`
+	if echo "$OUT" | grep -q -- '-E-'; then fail "$inf $*: `echo "$OUT" | grep -- '-E-' | head -1`"; return 1; fi
+	echo "$OUT" | grep -q 'Routing finished!' || { fail "$inf $*: routing did not finish"; return 1; }
+	return 0
+}
+
+# route as route does, fail unless all nets are routed
+route_all() {
+	route "$@" || return
+	echo "$OUT" | grep -q 'Routing finished! \([0-9]*\) out of \1 wires' || fail "$2: not all nets routed"
+}
+
+BIN=./maze-batch
+[ -x $BIN ] || { echo "-E- $BIN not found, run 'make batch' first! Exiting..."; exit 1; }
+
+# search engines and options, wave labels checked against Lee-Moore
+for opt in "-e l" "-e b" "-e a" "-e h" "-e s" "-e p" "-e p -j 2" "-w" "-i" "-f 14 24" "-m 2"; do
+	for inf in infiles/*.infile; do route $BIN $inf -c $opt; done
+done
+echo "-I- search engine checks done"
+
+# residue labels route the same nets as full wave values
+for eng in l b p; do
+	for inf in infiles/*.infile; do
+		route $BIN $inf -e $eng    || continue; full=`echo "$OUT" | grep 'Routing finished!'`
+		route $BIN $inf -e $eng -r || continue; mod3=`echo "$OUT" | grep 'Routing finished!'`
+		[ "$full" = "$mod3" ] || fail "$inf -e $eng -r: $mod3 instead of $full"
+	done
+done
+echo "-I- residue label checks done"
+
+# grid layout benchmark
+OUT=`$BIN -grid 256 2>&1`
+echo "$OUT" | grep -q ' 65536 tiles expanded' || fail "-grid 256: `echo "$OUT" | head -1`"
+echo "-I- grid benchmark check done"
+
+# arena scratch memory report
+for inf in infiles/*.infile; do
+	route $BIN $inf -verbose || continue
+	echo "$OUT" | grep -q 'arena scratch memory high-water mark: [1-9][0-9]* bytes' || fail "$inf -verbose: no arena high-water mark"
+done
+echo "-I- arena report checks done"
+
+# wide grid indices
+COL=100000; ROW=100000
+cp *.c *.h makefile $TMP/
+if make -s -C $TMP batch WIDE=1 > $TMP/wide.log 2>&1; then
+	printf "%u %u\n0\n2\n2 1 1 5 5\n2 %u %u %u %u\n" $COL $ROW $((COL-6)) $((ROW-6)) $((COL-2)) $((ROW-2)) > $TMP/wide.infile
+	route_all $TMP/maze-batch $TMP/wide.infile -margin 4
+	echo "-I- wide grid check on ${COL}x${ROW} tiles done"
+else
+	fail "make batch WIDE=1: `grep -i error $TMP/wide.log | head -1`"
+fi
+
+if [ $FAILED -eq 0 ]; then echo "-I- all checks passed"; fi
+exit $FAILED
@@ -33,22 +33,33 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include "common.h"
 
 /* safe memory allocation   */
-void *safeMalloc(unsigned int memSize) {
+void *safeMalloc(size_t memSize) {
 	void *mem=(void*)malloc(memSize);
 	if (!mem) {
-		printf("-E- memory allocation %u failed! Exiting...\n",memSize);
+		printf("-E- memory allocation %zu failed! Exiting...\n",memSize);
+		exit(-1);
+	}
+	return mem;
+}
+
+/* safe zeroed memory allocation, pages are committed on first write */
+void *safeCalloc(size_t memSize) {
+	void *mem=(void*)calloc(memSize,1);
+	if (!mem) {
+		printf("-E- memory allocation %zu failed! Exiting...\n",memSize);
 		exit(-1);
 	}
 	return mem;
 }
 
 /* safe memory reallocation */
-void *safeRealloc(void *memBlk, unsigned int memSize) {
+void *safeRealloc(void *memBlk, size_t memSize) {
 	void *mem=(void*)realloc(memBlk, memSize);
 	if (!mem) {
-		printf("-E- memory reallocation %u failed! Exiting...\n",memSize);
+		printf("-E- memory reallocation %zu failed! Exiting...\n",memSize);
 		exit(-1);
 	}
 	return mem;
@@ -59,3 +70,67 @@ void safeFree(void *memBlk) {
 	if (memBlk != NULL) free(memBlk);
 	else printf("-W- An attempt to free NULL pointer has been ignored\n");
 }
+
+/* new empty arena */
+arena *arenaCreate() {
+	arena *a = (arena*)safeMalloc(sizeof(arena));
+	a->size      = ARENA_BLOCK;
+	a->base      = (char*)safeMalloc(a->size);
+	a->used      = 0;
+	a->spill     = 0;
+	a->spillList = NULL;
+	a->high      = 0;
+	return a;
+}
+
+/* free an arena and its blocks */
+void arenaDelete(arena *a) {
+	arenaReset(a);
+	safeFree(a->base);
+	safeFree(a);
+}
+
+/* take i bytes, aligned to ARENA_ALIGN */
+void *arenaAlloc(arena *a, size_t i) {
+	void **blk;
+	i = (i+ARENA_ALIGN-1) & ~(size_t)(ARENA_ALIGN-1);
+	if (a->used+i <= a->size) {	/* fits the block */
+		a->used += i;
+		a->high = MAX(a->high,a->used+a->spill);
+		return a->base+a->used-i;
+	}
+	blk = (void**)safeMalloc(ARENA_ALIGN+i);	/* spill block, freed by the next reset */
+	blk[0] = a->spillList;
+	a->spillList = blk;
+	a->spill += i;
+	a->high = MAX(a->high,a->used+a->spill);
+	return (char*)blk+ARENA_ALIGN;
+}
+
+/* give back all memory taken since the last reset, spill blocks are freed *
+ * and the block grows to the high-water mark if it was too small          */
+void arenaReset(arena *a) {
+	void **blk;
+	while (a->spillList != NULL) {
+		blk = (void**)a->spillList;
+		a->spillList = blk[0];
+		safeFree(blk);
+	}
+	if (a->high > a->size) {
+		safeFree(a->base);
+		a->size = a->high;
+		a->base = (char*)safeMalloc(a->size);
+	}
+	a->used  = 0;
+	a->spill = 0;
+}
+
+/* current mark, for arenaRelease */
+size_t arenaMark(arena *a) {
+	return a->used;
+}
+
+/* give back block memory taken after mark (spill blocks are kept until the next reset) */
+void arenaRelease(arena *a, size_t mark) {
+	if (mark < a->used) a->used = mark;
+}
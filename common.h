@@ -34,12 +34,48 @@
 #ifndef __COMMON_HEADER__
 #define __COMMON_HEADER__
 
+#include <stddef.h>
+
 #define MAX(a,b) (((a) > (b))? (a) : (b))	/* two numbers max */
 #define MIN(a,b) (((a) > (b))? (b) : (a))   /* two numbers min */
 #define ABS(x)   (((x) < 0) ? -(x) : (x))   /* absolute value  */
 
-void *safeMalloc(int i);				/* safe memory allocation   */
-void *safeRealloc(void *memBlk, int i); /* safe memory reallocation */
-void safeFree(void *memBlk);            /* safe memory freeing      */
+/* grid index (iRow*col+iCol) of floorplan tiles and counts of them: unsigned int, or size_t for *
+ * grids of more than 2^32 tiles when built with 'make WIDE=1' (-DWIDE_INDEX)                    */
+#ifdef WIDE_INDEX
+typedef size_t       gridInd;
+#else
+typedef unsigned int gridInd;
+#endif
+#define GRID_NONE    ((gridInd)~(gridInd)0) /* no grid index (UINT_MAX unless wide) */
+
+void *safeMalloc(size_t i);                /* safe memory allocation   */
+void *safeCalloc(size_t i);                /* safe zeroed memory allocation, pages are committed on first write */
+void *safeRealloc(void *memBlk, size_t i); /* safe memory reallocation */
+void safeFree(void *memBlk);               /* safe memory freeing      */
+
+/* scratch memory arena (bump allocator) of one thread: arenaAlloc takes memory from a block and *
+ * arenaReset gives all of it back at once. requests that do not fit the block get spill blocks  *
+ * of their own until the next reset, which frees them and grows the block to the high-water     *
+ * mark, hence a steady state takes no heap allocations                                          */
+#define ARENA_ALIGN 16      /* alignment of arena allocations */
+#define ARENA_BLOCK 65536   /* initial block size             */
+struct arenaStr {
+	char   *base;      /* block                                                */
+	size_t  size;      /* block size                                           */
+	size_t  used;      /* bytes taken from the block                           */
+	size_t  spill;     /* bytes taken by spill blocks since the last reset     */
+	void   *spillList; /* spill blocks, linked by their first word             */
+	size_t  high;      /* high-water mark: most bytes taken between two resets */
+};
+
+typedef struct arenaStr arena;
+
+arena *arenaCreate();                          /* new empty arena                                 */
+void   arenaDelete(arena *a);                  /* free an arena and its blocks                    */
+void  *arenaAlloc(arena *a, size_t i);         /* take i bytes, aligned to ARENA_ALIGN            */
+void   arenaReset(arena *a);                   /* give back all memory taken since the last reset */
+size_t arenaMark(arena *a);                    /* current mark, for arenaRelease                  */
+void   arenaRelease(arena *a, size_t mark);    /* give back block memory taken after mark         */
 
 #endif /* __COMMON_HEADER__ */
@@ -38,40 +38,192 @@
 #include <errno.h>
 #include <limits.h>
 #include <ctype.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "floorplan.h"
+#ifndef HEADLESS
 #include "graphics.h"
+#endif
 #include "array.h"
 #include "common.h"
+#include "bitboard.h"
+#include "bucket.h"
+#include "parallel.h"
+
+/* the block of all unwritten tile map blocks: empty cells, unvisited tags (read-only) */
+const unsigned int fpZeroBlock[FP_BLOCK_SIZE] = {0};
+
+/* allocate a zeroed block of words words for tile map directory entry *entry, which is the zero  *
+ * block. threads writing a shared map may race for the entry: the first block stored is kept and *
+ * returned                                                                                       */
+__attribute__((noinline,cold))	/* first write of a block only, keeps the accessors inlined */
+unsigned int *fpBlockAlloc(unsigned int **entry, size_t words) {
+	unsigned int *b = (unsigned int*)safeCalloc(sizeof(unsigned int)*words);
+	if (!__sync_bool_compare_and_swap(entry,(unsigned int*)fpZeroBlock,b)) {	/* another thread was first */
+		safeFree(b);
+		b = __atomic_load_n(entry,__ATOMIC_RELAXED);
+	}
+	return b;
+}
+
+/* clear wave tag block #blk (tags) of floorplan f for the current search: all tiles become untouched. *
+ * threads sharing f race for the block by waveBlk, the others wait until the winner cleared it        */
+__attribute__((noinline,cold))	/* first write of a block by a search only */
+void fpWaveReset(fp *f, gridInd blk, unsigned char *tags) {
+	unsigned int *id=&f->waveBlk[blk], old;
+	while ((old = __atomic_load_n(id,__ATOMIC_ACQUIRE)) != f->waveEpoch) {
+		if ((old != FP_EPOCH_BUSY) && __sync_bool_compare_and_swap(id,old,FP_EPOCH_BUSY)) {
+			memset(tags,FP_WAVE_NEW,FP_BLOCK_SIZE);
+			__atomic_store_n(id,f->waveEpoch,__ATOMIC_RELEASE);
+		}
+	}
+}
+
+/* returns a tile map directory of floorplan f, all blocks are the zero block */
+static unsigned int **fpCreateMap(fp *f) {
+	unsigned int **dir = (unsigned int**)safeMalloc(sizeof(unsigned int*)*f->blockNum);
+	gridInd i;
+	for (i=0;i<f->blockNum;i++) dir[i] = (unsigned int*)fpZeroBlock;
+	return dir;
+}
 
+/* free tile map directory dir of floorplan f and its allocated blocks */
+static void fpDeleteMap(fp *f, unsigned int **dir) {
+	gridInd i;
+	for (i=0;i<f->blockNum;i++) if (dir[i] != fpZeroBlock) safeFree(dir[i]);
+	safeFree(dir);
+}
+
+/* allocate and reset the wave search state of floorplan f (grid size is set), *
+ * blocks of the wave maps are allocated as searches reach them               */
+static void fpCreateWave(fp *f) {
+	unsigned int col=f->col, row=f->row;
+	if (residue) {	/* 2-bit labels instead of wave values */
+		f->waveValue = NULL;
+		f->waveMod = fpCreateMap(f);
+	} else {
+		f->waveValue = fpCreateMap(f);
+		f->waveMod = NULL;
+	}
+	f->waveTag = fpCreateMap(f);
+	f->waveBlk = (unsigned int*)safeCalloc(sizeof(unsigned int)*f->blockNum); /* older than any search: unvisited */
+	f->curFront = (gridInd*)safeMalloc(sizeof(gridInd)*FP_FRONT_MIN); /* grown by the searches */
+	f->nxtFront = (gridInd*)safeMalloc(sizeof(gridInd)*FP_FRONT_MIN);
+	f->curFrontNum = 0;
+	f->nxtFrontNum = 0;
+	f->curFrontCap = FP_FRONT_MIN;
+	f->nxtFrontCap = FP_FRONT_MIN;
+	f->waveEpoch = 1;
+	f->treeCell = NULL;
+	f->treeNum = 0;
+	f->treeCap = 0;
+	f->treeWire = UINT_MAX;
+	f->bkFront = NULL; /* two-way search foreheads are allocated on first use */
+	f->bkNext = NULL;
+	f->bkFrontNum = 0;
+	f->bkNextNum = 0;
+	f->bkFrontCap = 0;
+	f->bkNextCap = 0;
+	f->visitCnt = 0;
+	f->winX0 = 0; /* search window is the whole grid */
+	f->winX1 = col-1;
+	f->winY0 = 0;
+	f->winY1 = row-1;
+	f->regX0 = 0; /* routing region is the whole grid */
+	f->regX1 = col-1;
+	f->regY0 = 0;
+	f->regY1 = row-1;
+	f->bq = NULL; /* bucket queue is allocated on first use */
+	f->bqEpoch = 0;
+	f->hTarget = NULL;
+	f->hSort = NULL;
+	f->hTargetNum = 0;
+	f->incWire = UINT_MAX; /* no distance field */
+	f->incHoldNum = 0;
+	f->bbPass = NULL; /* bitboards are allocated on first use */
+	f->bbEpoch = 0;
+	f->bbWire = UINT_MAX;
+	f->parWave = NULL; /* wave search threads are started on first use */
+	f->dirEpoch = 0;   /* no direction-optimizing search yet */
+	f->dirBottomUp = 0;
+	f->dirLabel = 0;
+	f->dirVisit = 0;
+	f->tdSteps = 0;
+	f->buSteps = 0;
+	f->arena = arenaCreate(); /* private scratch memory */
+	f->arenaHigh = 0;
+}
 
 /* returns a new grid floorplan data structure, size colXrow */
 fp *fpCreateGrid(unsigned int col, unsigned int row) {
-	int i;
-	int fpSize = col*row;
 	fp *f = (fp*)safeMalloc(sizeof(fp));
+	unsigned long long store;
 	f->col = col;
 	f->row = row;
-	f->cellValue = (unsigned int*)safeMalloc(sizeof(unsigned int)*fpSize);
-	f->waveValue = (unsigned int*)safeMalloc(sizeof(unsigned int)*fpSize);
-	f->cellType = (char*        )safeMalloc(sizeof(unsigned int)*fpSize);
-	f->waveType = (char*        )safeMalloc(sizeof(unsigned int)*fpSize);
-	for (i=0;i<fpSize;i++) {
-		f->cellValue[i] = UINT_MAX;
-		f->waveValue[i] = UINT_MAX;
-		f->cellType[i] = 'E';
-		f->waveType[i] = 'U';
+#if   FP_LAYOUT == FP_LAYOUT_TILE	/* whole tiles */
+	f->layoutArg = (col+(1ull<<FP_TILE_BITS)-1) >> FP_TILE_BITS;
+	store = ((unsigned long long)f->layoutArg*((row+(1ull<<FP_TILE_BITS)-1) >> FP_TILE_BITS)) << (2*FP_TILE_BITS);
+#elif FP_LAYOUT == FP_LAYOUT_MORTON	/* interleave the bits of the shorter side */
+	for (f->layoutArg=0;(1ull<<f->layoutArg)<MIN(col,row);f->layoutArg++);
+	store = ((MAX(col,row)+(1ull<<f->layoutArg)-1) >> f->layoutArg) << (2*f->layoutArg);
+#else
+	f->layoutArg = 0;
+	store = (unsigned long long)col*row;
+#endif
+	if (store >= GRID_NONE) {	/* grid indices would wrap around */
+		printf("-E- %ux%u grid is too large for %u-bit grid indices, build with 'make WIDE=1'! Exiting...\n",
+		       col,row,(unsigned int)(8*sizeof(gridInd)));
+		exit(-1);
 	}
+	f->store = store;
+	f->blockNum = FP_BLOCK(store+FP_BLOCK_SIZE-1);
+	f->view = 0;
+	f->probeView = NULL; /* blockage probe views are created on first use */
+	f->probeNum = 0;
+	f->cell = fpCreateMap(f); /* empty, no value */
+	fpCreateWave(f);
 	return f;
 }
 
+/* returns a view of floorplan f for a routing thread: wires are shared with f, grid cells too *
+ * unless copyGrid is set (then the view has a private tile map of empty cells, blocks are     *
+ * allocated as the caller copies regions of f into them). wave search state (values,          *
+ * foreheads, routed tree, queues and bitboards) is private                                    */
+fp *fpCreateView(fp *f, int copyGrid) {
+	fp *v = (fp*)safeMalloc(sizeof(fp));
+	*v = *f;		/* share grid cells and wires */
+	v->view = 1;
+	v->ripCnt    = (unsigned int*)safeMalloc(sizeof(unsigned int)*f->wireNum);	/* private counters */
+	v->ripCntAcc = (unsigned int*)safeMalloc(sizeof(unsigned int)*f->wireNum);
+	memset(v->ripCnt   ,0,sizeof(unsigned int)*f->wireNum);
+	memset(v->ripCntAcc,0,sizeof(unsigned int)*f->wireNum);
+	v->probeView = NULL;
+	v->probeNum  = 0;
+	if (copyGrid) {	/* private grid cells */
+		v->cell = fpCreateMap(f);
+		v->view = 2;
+	}
+	fpCreateWave(v);
+	return v;
+}
+
 /* creates a new wires data structure inside a floorplan structure */
 void fpCreateWires(fp *f, unsigned int wireNum) {
 	int i;
+	if (wireNum >= FP_VALUE_MASK) {	/* wire numbers are packed into grid cells */
+		printf("-E- too many wires, at most %u wires are supported! Exiting...\n",FP_VALUE_MASK-1);
+		exit(-1);
+	}
 	f->wireNum = wireNum;
 	f->srcX = (unsigned int*)safeMalloc(sizeof(unsigned int)*wireNum);
 	f->srcY = (unsigned int*)safeMalloc(sizeof(unsigned int)*wireNum);
-	f->bbox = (unsigned int*)safeMalloc(sizeof(unsigned int)*wireNum);
+	f->bbox = (gridInd*)safeMalloc(sizeof(gridInd)*wireNum);
 	f->dstNum = (unsigned int*)safeMalloc(sizeof(unsigned int)*wireNum);
+	f->dstX = (unsigned int**)safeMalloc(sizeof(unsigned int*)*wireNum);
+	f->dstY = (unsigned int**)safeMalloc(sizeof(unsigned int*)*wireNum);
 	f->routeOrder = (unsigned int*)safeMalloc(sizeof(unsigned int)*wireNum);
 	f->ripCnt = (unsigned int*)safeMalloc(sizeof(unsigned int)*wireNum);
 	f->ripCntAcc = (unsigned int*)safeMalloc(sizeof(unsigned int)*wireNum);
@@ -80,21 +232,66 @@ void fpCreateWires(fp *f, unsigned int wireNum) {
 		f->srcY[i] = 0;
 		f->bbox[i] = 0;
 		f->dstNum[i] = 0;
+		f->dstX[i] = NULL;
+		f->dstY[i] = NULL;
 		f->routeOrder[i] = i;
 		f->ripCnt[i] = 0;
 		f->ripCntAcc[i] = 0;
 	}
 }
 
-/* free a floorplan data structure */
+/* free the wave search state of floorplan f */
+static void fpDeleteWave(fp *f){
+	if (f->waveValue != NULL) fpDeleteMap(f,f->waveValue);
+	if (f->waveMod   != NULL) fpDeleteMap(f,f->waveMod  );
+	fpDeleteMap(f,f->waveTag);
+	safeFree(f->waveBlk);
+	safeFree(f->curFront);
+	safeFree(f->nxtFront);
+	if (f->treeCell != NULL) safeFree(f->treeCell);
+	if (f->bkFront != NULL) {
+		safeFree(f->bkFront);
+		safeFree(f->bkNext);
+	}
+	if (f->bq != NULL) bqDelete(f->bq);
+	if (f->hTarget != NULL) {
+		safeFree(f->hTarget);
+		safeFree(f->hSort);
+	}
+	if (f->bbPass != NULL) {
+		bbDelete(f->bbPass);
+		bbDelete(f->bbFront);
+		bbDelete(f->bbNext);
+		bbDelete(f->bbVisit);
+		bbDelete(f->bbTarget);
+	}
+	if (f->parWave != NULL) parWaveStop(f);
+	arenaDelete(f->arena);
+}
+
+/* free a floorplan data structure, or a view (fpCreateView) without the shared grid and wires */
 void fpDelete(fp *f){
-	safeFree(f->cellValue);
-	safeFree(f->cellType);
-	safeFree(f->waveValue );
-	safeFree(f->waveType);
+	unsigned int i;
+	fpDeleteWave(f);
+	if (f->view) {
+		if (f->view == 2) fpDeleteMap(f,f->cell);	/* private grid cells */
+		safeFree(f->ripCnt);
+		safeFree(f->ripCntAcc);
+		safeFree(f);
+		return;
+	}
+	for (i=0;i<f->probeNum;i++) fpDelete(f->probeView[i]);
+	if (f->probeView != NULL) safeFree(f->probeView);
+	fpDeleteMap(f,f->cell);
 	safeFree(f->srcX);
 	safeFree(f->srcY);
 	safeFree(f->bbox);
+	for (i=0;i<f->wireNum;i++) {
+		if (f->dstX[i] != NULL) safeFree(f->dstX[i]);
+		if (f->dstY[i] != NULL) safeFree(f->dstY[i]);
+	}
+	safeFree(f->dstX);
+	safeFree(f->dstY);
 	safeFree(f->dstNum);
 	safeFree(f->routeOrder);
 	safeFree(f->ripCnt);
@@ -102,54 +299,149 @@ void fpDelete(fp *f){
 	safeFree(f);
 }
 
+/* code of cell type cellType in packed grid cells (FP_CELL_TYPES) */
+static inline unsigned int fpCellCode(char cellType){
+	switch (cellType) {
+		case 'E': return FP_CELL_E;
+		case 'B': return 1;
+		case 'W': return 2;
+		case 'S': return 3;
+		case 'T': return FP_CELL_T;
+		case 's': return 5;
+		case 't': return 6;
+		default : return 7;	/* 'w' */
+	}
+}
+
+/* code of wave type waveType in packed wave tags (FP_WAVE_TYPES) */
+static inline unsigned int fpWaveCode(char waveType){
+	switch (waveType) {
+		case 'U': return FP_WAVE_U;
+		case 'V': return FP_WAVE_V;
+		case 'F': return FP_WAVE_F;
+		case 'f': return 3;
+		case 'R': return 4;
+		default : return 5;	/* 'r' */
+	}
+}
+
 /* set floorplan grid cell value at (iCol,iRow) floorplan grid place*/
 inline void fpSetCellValue(fp *f, unsigned int iCol, unsigned int iRow, unsigned int cellValue){
-    f->cellValue[iRow*f->col+iCol]=cellValue;
+	unsigned int *cell=FP_MAP_W(f->cell,fpAt(f,iCol,iRow));
+	*cell = (*cell & ~FP_VALUE_MASK) | FP_CELL(0,cellValue);
+}
+
+/* store wave value waveValue of storage index at as a residue label (label mod 3) */
+static void fpStoreMod(fp *f, gridInd at, unsigned int waveValue){
+	unsigned int *word=fpBlockW(f->waveMod,FP_BLOCK(at),FP_MOD_BLOCK)+FP_MOD_WORD(at);
+	unsigned int shift=FP_MOD_SHIFT(at);
+	*word = (*word & ~(3u << shift)) | (FP_MOD_LABEL(waveValue) << shift);
+}
+
+/* store wave value waveValue of storage index at, as a label mod 3 with residue labels */
+static inline void fpStoreWave(fp *f, gridInd at, unsigned int waveValue){
+	if (f->waveMod == NULL) *FP_MAP_W(f->waveValue,at) = waveValue;
+	else                    fpStoreMod(f,at,waveValue);
+}
+
+/* load wave value of storage index at, only the label mod 3 with residue labels */
+static inline unsigned int fpLoadWave(fp *f, gridInd at){
+	unsigned int label;
+	if (f->waveMod == NULL) return FP_MAP(f->waveValue,at);
+	label = (f->waveMod[FP_BLOCK(at)][FP_MOD_WORD(at)] >> FP_MOD_SHIFT(at)) & 3;
+	return (label == FP_MOD_NONE) ? UINT_MAX : label;
+}
+
+/* bring the wave state of storage index ind into the current search, untouched tiles become unvisited. *
+ * returns the wave tag of ind                                                                          */
+static inline unsigned char *fpWaveTouch(fp *f, gridInd ind){
+	unsigned char *tag=fpWaveBlock(f,FP_BLOCK(ind))+FP_BLOCK_OFF(ind);
+	if (*tag == FP_WAVE_NEW) {
+		*tag=FP_WAVE_TAG(FP_WAVE_U);
+		fpStoreWave(f,ind,UINT_MAX);
+	}
+	return tag;
 }
 
 /* set expansion wave value at (iCol,iRow) floorplan grid place */
 inline void fpSetWaveValue(fp *f, unsigned int iCol, unsigned int iRow, unsigned int waveValue){
-    f->waveValue[iRow*f->col+iCol]=waveValue;
+	gridInd at=fpAt(f,iCol,iRow);
+	unsigned char *tag=fpWaveBlock(f,FP_BLOCK(at))+FP_BLOCK_OFF(at);
+	if (*tag == FP_WAVE_NEW) *tag=FP_WAVE_TAG(FP_WAVE_U); /* untouched: unvisited */
+    fpStoreWave(f,at,waveValue);
 }
 
 /* set floorplan grid cell type at (iCol,iRow) floorplan grid place*/
 inline void fpSetCellType(fp *f, unsigned int iCol, unsigned int iRow, char cellType){
-    f->cellType[iRow*f->col+iCol]=cellType;
+	unsigned int *cell=FP_MAP_W(f->cell,fpAt(f,iCol,iRow));
+	*cell = ((unsigned int)fpCellCode(cellType) << FP_TYPE_SHIFT) | (*cell & FP_VALUE_MASK);
+	if (f->bbPass != NULL) { /* keep empty tiles bitboard up to date */
+		if (cellType == 'E') bbSet(f->bbPass,iCol,iRow);
+		else                 bbClr(f->bbPass,iCol,iRow);
+	}
 }
 
 /* set expansion wave type at (iCol,iRow) floorplan grid place*/
 inline void fpSetWaveType(fp *f, unsigned int iCol, unsigned int iRow, char waveType){
-    f->waveType[iRow*f->col+iCol]=waveType;
+	gridInd at=fpAt(f,iCol,iRow);
+    *fpWaveTouch(f,at)=FP_WAVE_TAG(fpWaveCode(waveType));
 }
 
 /* get floorplan grid cell value from (iCol,iRow) floorplan grid place*/
 inline unsigned int fpGetCellValue(fp *f, unsigned int iCol, unsigned int iRow){
-    return(f->cellValue[iRow*f->col+iCol]);
+    return(FP_CELL_VALUE(FP_MAP(f->cell,fpAt(f,iCol,iRow))));
 }
 
-/* get expansion wave value from (iCol,iRow) floorplan grid place */
+/* get expansion wave value from (iCol,iRow) floorplan grid place (mod 3 with residue labels) */
 inline unsigned int fpGetWaveValue(fp *f, unsigned int iCol, unsigned int iRow){
-    return(f->waveValue[iRow*f->col+iCol]);
+	gridInd at=fpAt(f,iCol,iRow);
+	if (fpWaveTagAt(f,at) == FP_WAVE_NEW) return UINT_MAX; /* untouched: unvisited */
+    return(fpLoadWave(f,at));
 }
 
 /* get floorplan grid cell type from (iCol,iRow) floorplan grid place*/
 inline char fpGetCellType(fp *f, unsigned int iCol, unsigned int iRow){
-    return(f->cellType[iRow*f->col+iCol]);
+    return(FP_CELL_TYPE(FP_MAP(f->cell,fpAt(f,iCol,iRow))));
 }
 
 /* get expansion wave type from (iCol,iRow) floorplan grid place*/
 inline char fpGetWaveType(fp *f, unsigned int iCol, unsigned int iRow){
-    return(f->waveType[iRow*f->col+iCol]);
+    return(FP_WAVE_TYPE(fpWaveTagAt(f,fpAt(f,iCol,iRow)))); /* untouched: unvisited */
+}
+
+/* number of tiles from (iCol,iRow) along its row that scans for wires and pins skip as empty: *
+ * the rest of its tile map block if the block was never written, else 1 if the tile is empty *
+ * and 0 if not                                                                               */
+static inline unsigned int fpEmptyRun(fp *f, unsigned int iCol, unsigned int iRow){
+	gridInd at=fpAt(f,iCol,iRow);
+	unsigned int *b=f->cell[FP_BLOCK(at)];
+	if (b != fpZeroBlock) return FP_CELL_EMPTY(b[FP_BLOCK_OFF(at)]);
+#if   FP_LAYOUT == FP_LAYOUT_TILE	/* a block is a tile */
+	return (1u << FP_TILE_BITS) - (iCol & ((1u << FP_TILE_BITS)-1));
+#elif FP_LAYOUT == FP_LAYOUT_MORTON	/* aligned squares up to a tile are in one block */
+	return (1u << MIN(f->layoutArg,FP_TILE_BITS)) - (iCol & ((1u << MIN(f->layoutArg,FP_TILE_BITS))-1));
+#else
+	return FP_BLOCK_SIZE - (unsigned int)FP_BLOCK_OFF(at);
+#endif
 }
 
 /* set location (srcX,srcY) and number of destinations (dstNum) and bounding box area (bbox) of wire #iWire */
-void fpSetWire(fp *f, unsigned int iWire, unsigned int srcX, unsigned int srcY, unsigned int dstNum, unsigned int bbox) {
+void fpSetWire(fp *f, unsigned int iWire, unsigned int srcX, unsigned int srcY, unsigned int dstNum, gridInd bbox) {
 	f->srcX[iWire]=srcX;
 	f->srcY[iWire]=srcY;
 	f->dstNum[iWire]=dstNum;
 	f->bbox[iWire]=bbox;
+	f->dstX[iWire]=(unsigned int*)safeMalloc(sizeof(unsigned int)*MAX(dstNum,1));
+	f->dstY[iWire]=(unsigned int*)safeMalloc(sizeof(unsigned int)*MAX(dstNum,1));
+}
+
+/* set location (dstX,dstY) of destination #iDst of wire #iWire, after fpSetWire */
+void fpSetTarget(fp *f, unsigned int iWire, unsigned int iDst, unsigned int dstX, unsigned int dstY) {
+	f->dstX[iWire][iDst]=dstX;
+	f->dstY[iWire][iDst]=dstY;
 }
 
+#ifndef HEADLESS
 /* draw floorplan using EasyGl graphics module. Wold size is (xDim X yDim) */
 void fpDraw(fp *f, float xDim, float yDim) {
 	unsigned int iRow=0, iCol=0;                /* counters         */
@@ -297,12 +589,12 @@ void fpDraw(fp *f, float xDim, float yDim) {
 			cellType = fpGetCellType(f,iCol,iRow);
 			switch(toupper(cellType)) {
 				case 'E':	/* empty cell */
-					if (waveType == 'V') {	/* visited while expansion*/
+					if ((waveType == 'V') || (waveType == 'r')) {	/* visited while expansion*/
 						setcolor(LIGHTGREY);
 						fillrect(curCol,curRow,curCol+step,curRow+step);
 						setcolor(BLACK);
 						drawtext(curCol+step/2,curRow+step/2,elabel,step);
-					} else if (toupper(waveType) == 'F') {	/* wave expansion forehead */
+					} else if ((toupper(waveType) == 'F') || (waveType == 'R')) {	/* wave expansion forehead */
 						setcolor(YELLOW);
 						fillrect(curCol,curRow,curCol+step,curRow+step);
 						setcolor(BLACK);
@@ -359,133 +651,230 @@ void fpDraw(fp *f, float xDim, float yDim) {
 		iRow++;
 	}
 }
+#endif /* HEADLESS */
 
-/* parse floorplan infile format into a new floorplan structue, return a new allocated structure */
-fp *fpInfileParse(const char* fileName) {
-	FILE *infile;
-	fp *f;
-	char line[128];
-	unsigned int buf[128];
-	int i=0,bufInd=-1;
-	char delims[] = " \t\n"; /* delimiters: space, tap, and new line */
-	char *res = NULL;
-	unsigned long val;
-	unsigned int lineNum=1;
-	unsigned int blockCnt=0, wireCnt=0;
-	int state=1;
-	unsigned int gridCols=0, gridRows=0, blockNum=0, wireNum=0;
-	unsigned int maxX,maxY,minX,minY;
+/* report a parsing error at the current line and exit */
+void fpScanError(struct fpScan *s, const char *msg) {
+	printf("-E- Parsing error in file %s, line %u: %s! Exiting...\n",s->fileName,s->lineNum,msg);
+	exit(-1);
+}
 
-	infile=fopen(fileName,"r");
-	if(infile==NULL) { /* open failed */
-		printf("-E- File open error %s! Exiting...\n", fileName); exit(-1);
+/* blanks between integers: space, tab, and the carriage return of DOS line ends */
+static inline int fpScanBlank(char c) {
+	return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\v') || (c == '\f');
+}
+
+/* skip empty lines, returns 0 at the end of the file */
+int fpScanLine(struct fpScan *s) {
+	while (s->p < s->end) {
+		if (*s->p == '\n') s->lineNum++;
+		else if (!fpScanBlank(*s->p)) return 1;
+		s->p++;
 	}
+	return 0;
+}
 
-	while (fgets(line,sizeof line,infile) != NULL ) {	/* read a line */
+/* scan the next integer of the current line into val, returns 0 at the end of the line */
+static int fpScanInt(struct fpScan *s, unsigned int *val) {
+	const char *p=s->p, *end=s->end;
+	unsigned long long v=0;
+	while ((p < end) && fpScanBlank(*p)) p++;
+	s->p = p;
+	if ((p == end) || (*p == '\n')) return 0;
+	if ((*p < '0') || (*p > '9')) fpScanError(s,"value is not positive integer");
+	do {
+		v = v*10 + (unsigned int)(*p++ - '0');
+		if (v > UINT_MAX) fpScanError(s,"value is too large");
+	} while ((p < end) && (*p >= '0') && (*p <= '9'));
+	if ((p < end) && (*p != '\n') && !fpScanBlank(*p)) fpScanError(s,"value is not positive integer");
+	s->p = p;
+	*val = (unsigned int)v;
+	return 1;
+}
 
-		bufInd=-1;
-		res = strtok( line, delims );     /* read token from line               */
-		while(res != NULL) {              /* read all tokens                    */
-			val = strtoul(res, NULL, 10); /* convert string to unsigned int     */
-			if (errno != 0) {             /* conversion failed (EINVAL, ERANGE) */
-				printf("-E- Parsing error in file %s, line %u: value is not positive integer! Exiting...\n",fileName,lineNum);
-				exit(-1);
-			}
-        		bufInd++;		/* holds number of tokens */
-			buf[bufInd]=val;	/* hold integer tokens */
+/* scan the rest of the current line into buf (up to bufMax integers), returns the number of *
+ * integers scanned; all of them are checked even when not kept                               */
+unsigned int fpScanRest(struct fpScan *s, unsigned int *buf, unsigned int bufMax) {
+	unsigned int n=0, val;
+	while (fpScanInt(s,&val)) {
+		if (n < bufMax) buf[n] = val;
+		n++;
+	}
+	return n;
+}
 
-			
-			res = strtok(NULL,delims); /* next token */
-		}
-		if (bufInd<0) continue; /* empty line */
+/* report a wire line that does not have the integers of its n pins */
+static void fpScanPinError(struct fpScan *s, unsigned int n) {
+	char msg[64];
+	sprintf(msg,"Should include %llu integer numbers",1+2ULL*n);
+	fpScanError(s,msg);
+}
 
-		switch(state) {
+/* check that (x,y) is a grid location */
+static void fpScanCheckCell(struct fpScan *s, fp *f, unsigned int x, unsigned int y) {
+	char msg[96];
+	if ((x >= f->col) || (y >= f->row)) {
+		sprintf(msg,"location (%u,%u) is out of the %ux%u grid",x,y,f->col,f->row);
+		fpScanError(s,msg);
+	}
+}
 
-		 /*read gird size*/
-		 case 1:if (bufInd != 1) {
-				printf("-E- Parsing error in file %s, line %u: Should include two integer numbers! Exiting...\n",fileName,lineNum);
-				exit(-1);
-			}
-			gridCols=buf[0];
-			gridRows=buf[1];
-			f=fpCreateGrid(gridCols,gridRows);
-			state=2;
-			break;
+/* count the non-empty lines of s (returned) and its new lines (lines), s is not moved */
+unsigned int fpScanCount(struct fpScan *s, unsigned int *lines) {
+	const char *p=s->p, *end=s->end;
+	unsigned int n=0, nl=0;
+	int full=0;	/* current line has an integer */
+	for (;p<end;p++) {
+		if (*p == '\n') { n+=full; nl++; full=0; }
+		else if (!fpScanBlank(*p)) full=1;
+	}
+	*lines = nl;
+	return n+full;
+}
 
-		 /* read number of blockages */
-		 case 2:if (bufInd != 0) {
-				printf("-E- Parsing error in file %s, line %u: Should include one integer numbers",fileName,lineNum);
-				exit(-1);
-			}
-			blockNum=buf[0];
-			state=3;
-			break;
+/* parser: block (x,y) unless a pin is there. blockages precede the wires in the infile, hence a *
+ * pin always wins, also when parsing threads write the cell in another order (parInfileParse)   */
+static inline void fpPutBlock(fp *f, unsigned int x, unsigned int y) {
+	unsigned int *cell=FP_MAP_W(f->cell,fpAt(f,x,y)), old, code;
+	do {
+		old  = __atomic_load_n(cell,__ATOMIC_RELAXED);
+		code = old >> FP_TYPE_SHIFT;
+		if ((code == fpCellCode('S')) || (code == fpCellCode('T'))) return;
+	} while (!__sync_bool_compare_and_swap(cell,old,(fpCellCode('B') << FP_TYPE_SHIFT) | (old & FP_VALUE_MASK)));
+}
 
-		 /* read blockages coordinates*/
-		 case 3:if (blockCnt==blockNum-1) state=4;
-			if (bufInd != 1) {
-				printf("-E- Parsing error in file %s, line %u: Should include two integer numbers! Exiting...\n",fileName,lineNum);
-				exit(-1);
-			}	
-			fpSetCellType(f,buf[0],buf[1],'B');
-			blockCnt++;
-			break;
+/* parser: put pin cellType of wire #wireNum at (x,y) unless a pin of a later wire is there, *
+ * as in infile order, also when parsing threads write the cell in another order            */
+static inline void fpPutPin(fp *f, unsigned int x, unsigned int y, char cellType, unsigned int wireNum) {
+	unsigned int *cell=FP_MAP_W(f->cell,fpAt(f,x,y)), old, code;
+	do {
+		old  = __atomic_load_n(cell,__ATOMIC_RELAXED);
+		code = old >> FP_TYPE_SHIFT;
+		if (((code == fpCellCode('S')) || (code == fpCellCode('T'))) && (FP_CELL_VALUE(old) > wireNum)) return;
+	} while (!__sync_bool_compare_and_swap(cell,old,FP_CELL(fpCellCode(cellType),wireNum)));
+}
 
-		 /* read number of wires */
-		 case 4:if (bufInd != 0) { 
-				printf("-E- Parsing error in file %s, line %u: Should include one integer numbers! Exiting...\n",fileName,lineNum);
-				exit(-1);
-			}
-			wireNum=buf[0];
-			fpCreateWires(f,wireNum);
-			state=5;
-			break;
+/* parse a blockage line at s */
+static void fpParseBlock(struct fpScan *s, fp *f) {
+	unsigned int buf[2];
+	if (fpScanRest(s,buf,2) != 2) fpScanError(s,"Should include two integer numbers");
+	fpScanCheckCell(s,f,buf[0],buf[1]);
+	fpPutBlock(f,buf[0],buf[1]);
+}
 
-		 /* read a wire */
-		 case 5:if (wireCnt==wireNum-1) state=6; /* if finished check extra lines */
-			if (bufInd < 0) { 
-				printf("-E- Parsing error in file %s, line %u: Should include at least one integer numbers! Exiting...\n",fileName,lineNum);
-				exit(-1);
-			}
-			if (bufInd != (2*buf[0])) { /* read a wire */
-				printf("-E- Parsing error in file %s, line %u: Should include %u integer numbers! Exiting...\n",fileName,lineNum, 1+2*buf[0]);
-				exit(-1);
-			}
-			
-			/* set wire source */
-			fpSetCellType(f,buf[1],buf[2],'S');
-			fpSetCellValue(f,buf[1],buf[2],wireCnt);
-			
-			/* find wire bbox */
-			maxX=buf[1];
-			minX=buf[1];
-			maxY=buf[2];
-			minY=buf[2];
-			for (i=3;i<=bufInd;i+=2) {
-				fpSetCellType(f,buf[i],buf[i+1],'T');
-				fpSetCellValue(f,buf[i],buf[i+1],wireCnt);
-				maxX=MAX(maxX,buf[i]);
-				minX=MIN(minX,buf[i]);
-				maxY=MAX(maxY,buf[i+1]);
-				minY=MIN(minY,buf[i+1]);
-			}
+/* parse the line of wire #wireCnt at s: pin count, source and targets; targets are stored directly *
+ * as they are scanned                                                                              */
+static void fpParseWire(struct fpScan *s, fp *f, unsigned int wireCnt) {
+	unsigned int i, n, dstNum;
+	unsigned int srcX, srcY, x, y;
+	unsigned int maxX,maxY,minX,minY;
+	fpScanInt(s,&n);
+	if (n == 0) fpScanError(s,"Should include at least three integer numbers");
+	if (!fpScanInt(s,&srcX) || !fpScanInt(s,&srcY)) fpScanPinError(s,n);
+	fpScanCheckCell(s,f,srcX,srcY);
+	dstNum=n-1;
+
+	/* set wire source */
+	fpPutPin(f,srcX,srcY,'S',wireCnt);
+	fpSetWire(f,wireCnt,srcX,srcY,dstNum,0);
+
+	/* set targets and find wire bbox */
+	maxX=minX=srcX;
+	maxY=minY=srcY;
+	for (i=0;i<dstNum;i++) {
+		if (!fpScanInt(s,&x) || !fpScanInt(s,&y)) fpScanPinError(s,n);
+		fpScanCheckCell(s,f,x,y);
+		fpPutPin(f,x,y,'T',wireCnt);
+		fpSetTarget(f,wireCnt,i,x,y);
+		maxX=MAX(maxX,x);
+		minX=MIN(minX,x);
+		maxY=MAX(maxY,y);
+		minY=MIN(minY,y);
+	}
+	f->bbox[wireCnt]=(gridInd)(maxX-minX+1)*(maxY-minY+1);	/* up to the grid size */
+	if (fpScanRest(s,NULL,0) != 0) fpScanPinError(s,n);
+}
 
-			/* set wire attributes */
-			fpSetWire(f,wireCnt,buf[1],buf[2],(bufInd-1)/2,(maxX-minX+1)*(maxY-minY+1));
-			
-			wireCnt++; /* next wire */
-			break;
+/* parse the lines of s into f, line is the index of the first non-empty line of s after the *
+ * number of blockages line: blockages, the number of wires (skipped) and then the wires     */
+void fpParseLines(fp *f, struct fpScan *s, unsigned long long line, unsigned int blockNum) {
+	for (;fpScanLine(s);line++) {
+		if      (line <  blockNum) fpParseBlock(s,f);
+		else if (line == blockNum) fpScanRest(s,NULL,0);	/* number of wires, read before */
+		else if (line-blockNum-1 < f->wireNum) fpParseWire(s,f,(unsigned int)(line-blockNum-1));
+		else fpScanError(s,"Extra line");
+	}
+}
 
-		 /* check extra lines */
-		 case 6: if (bufInd != -1) { 
-				printf("-E- Parsing error in file %s, line %u: Extra line! Exiting...\n",fileName,lineNum);
-				exit(-1);
-			}
+/* parse floorplan infile format into a new floorplan structue, return a new allocated structure *
+ * the file is memory-mapped and scanned in place, hence lines and nets have no size limit;      *
+ * with -jobs, large blockage and wire sections are parsed in chunks by threads                  */
+fp *fpInfileParse(const char* fileName) {
+	int fd;
+	struct stat st;
+	char *map=NULL;
+	struct fpScan s;
+	fp *f;
+	unsigned int buf[2];
+	unsigned int blockCnt, wireCnt;
+	unsigned int blockNum, wireNum;
+
+	fd=open(fileName,O_RDONLY);
+	if((fd<0) || (fstat(fd,&st)<0)) { /* open failed */
+		printf("-E- File open error %s! Exiting...\n", fileName); exit(-1);
+	}
+	if (st.st_size > 0) {
+		map=(char*)mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+		if (map==MAP_FAILED) {
+			printf("-E- File mapping error %s! Exiting...\n", fileName); exit(-1);
+		}
+		madvise(map,st.st_size,MADV_SEQUENTIAL);	/* read once, front to back */
+	}
+	close(fd);
+	s.p        = map;
+	s.end      = map+st.st_size;
+	s.fileName = fileName;
+	s.lineNum  = 1;
+
+	/* read gird size */
+	if (!fpScanLine(&s)) fpScanError(&s,"Missing grid size");
+	if (fpScanRest(&s,buf,2) != 2) fpScanError(&s,"Should include two integer numbers");
+	f=fpCreateGrid(buf[0],buf[1]);
+
+	/* read number of blockages */
+	if (!fpScanLine(&s)) fpScanError(&s,"Missing number of blockages");
+	if (fpScanRest(&s,buf,1) != 1) fpScanError(&s,"Should include one integer numbers");
+	blockNum=buf[0];
+
+	/* blockages and wires of large infiles: in chunks by -jobs threads */
+	if ((jobs > 1) && (s.end-s.p >= 2*PAR_CHUNK)) {
+		parInfileParse(f,&s,blockNum,jobs);
+		if (map != NULL) munmap(map,st.st_size);
+		return f;
+	}
+
+	/* read blockages coordinates */
+	for (blockCnt=0;blockCnt<blockNum;blockCnt++) {
+		if (!fpScanLine(&s)) fpScanError(&s,"Missing blockages");
+		fpParseBlock(&s,f);
+	}
+
+	/* read number of wires */
+	if (!fpScanLine(&s)) fpScanError(&s,"Missing number of wires");
+	if (fpScanRest(&s,buf,1) != 1) fpScanError(&s,"Should include one integer numbers");
+	wireNum=buf[0];
+	fpCreateWires(f,wireNum);
+
+	/* read wires */
+	for (wireCnt=0;wireCnt<wireNum;wireCnt++) {
+		if (!fpScanLine(&s)) fpScanError(&s,"Missing wires");
+		fpParseWire(&s,f,wireCnt);
+	}
 
-		} /* switch */		
-	} /* while fgets */
+	/* check extra lines */
+	if (fpScanLine(&s)) fpScanError(&s,"Extra line");
 
-	fclose(infile);
+	if (map != NULL) munmap(map,st.st_size);
 	return f;
 }
 
@@ -493,111 +882,1152 @@ fp *fpInfileParse(const char* fileName) {
 * Lee-Moore multi-destination maze routing related algorithms *
 ***************************************************************/
 
+/* start a new wave search, all tiles become unvisited in O(1) by advancing the search id */
+void fpNewWave(fp  *f) {
+	f->curFrontNum = 0;
+	f->nxtFrontNum = 0;
+	if (++(f->waveEpoch) == FP_EPOCH_END) {	/* search id wrapped around, clear all block ids once */
+		memset(f->waveBlk,0,sizeof(unsigned int)*f->blockNum);
+		f->waveEpoch = 1;
+		f->bbEpoch   = 0;	/* search state tagged by old ids is stale */
+		f->bqEpoch   = 0;
+		f->incEpoch  = 0;
+		f->dirEpoch  = 0;
+		f->dirVisit  = 0;
+	}
+}
+
+/* add cell (iCol,iRow) to the routed tree of wire #wireNum (f->treeCell), *
+ * the tree is restarted if it belongs to another wire                    */
+void fpAddTree(fp  *f, unsigned int iCol, unsigned int iRow, unsigned int wireNum) {
+	if (f->treeWire != wireNum) {	/* new wire */
+		f->treeWire = wireNum;
+		f->treeNum = 0;
+	}
+	if (f->treeNum == f->treeCap) {	/* grow tree buffer */
+		f->treeCap = MAX(64,2*f->treeCap);
+		f->treeCell = (gridInd*)safeRealloc(f->treeCell,sizeof(gridInd)*f->treeCap);
+	}
+	f->treeCell[f->treeNum++] = (gridInd)iRow*f->col+iCol;
+}
+
+/* make room for n cells in forehead buffer *front of *cap cells, at least doubling it */
+void fpGrowFront(gridInd **front, gridInd *cap, gridInd n) {
+	if (n <= *cap) return;
+	*cap = MAX(n,2*(*cap));
+	*front = (gridInd*)safeRealloc(*front,sizeof(gridInd)*(*cap));
+}
+
+/* new forehead (f->nxtFront) becomes the current one, the old buffer is reused for the next */
+void fpSwapFront(fp  *f) {
+	gridInd *swp=f->curFront, cap=f->curFrontCap;
+	f->curFront    = f->nxtFront;
+	f->curFrontCap = f->nxtFrontCap;
+	f->curFrontNum = f->nxtFrontNum;
+	f->nxtFront    = swp;
+	f->nxtFrontCap = cap;
+	f->nxtFrontNum = 0;
+}
+
+/* add cell (iCol,iRow) to the current wave forehead (f->curFront) */
+void fpAddFront(fp  *f, unsigned int iCol, unsigned int iRow) {
+	fpSetWaveType(f,iCol,iRow,'F');
+	if (f->curFrontNum == f->curFrontCap) fpGrowFront(&f->curFront,&f->curFrontCap,f->curFrontNum+1);
+	f->curFront[f->curFrontNum++] = (gridInd)iRow*f->col+iCol;
+}
+
+/* check if cell (iCol,iRow) is an unrouted target of wire #wireNum */
+static inline int fpIsTarget(fp  *f, unsigned int iCol, unsigned int iRow, unsigned int wireNum) {
+	return FP_MAP(f->cell,fpAt(f,iCol,iRow)) == FP_CELL(FP_CELL_T,wireNum);	/* packed unrouted target cell */
+}
+
+/* check if a neighbor of forehead cell (iCol,iRow) is an unrouted target of wire #wireNum *
+ * neighbors are checked in right, left, down, up order, the last found one is returned   *
+ * returns:- 0: no target around, 1: target found at (*targetX,*targetY)                   */
+static int fpTouchTarget(fp  *f, unsigned int iCol, unsigned int iRow, unsigned int wireNum,
+                                 unsigned int *targetX, unsigned int *targetY) {
+	int found = 0;
+	if ((iCol < f->col-1) && fpIsTarget(f,iCol+1,iRow,wireNum)) {*targetX=iCol+1; *targetY=iRow; found=1;}
+	if ((iCol > 0       ) && fpIsTarget(f,iCol-1,iRow,wireNum)) {*targetX=iCol-1; *targetY=iRow; found=1;}
+	if ((iRow < f->row-1) && fpIsTarget(f,iCol,iRow+1,wireNum)) {*targetX=iCol; *targetY=iRow+1; found=1;}
+	if ((iRow > 0       ) && fpIsTarget(f,iCol,iRow-1,wireNum)) {*targetX=iCol; *targetY=iRow-1; found=1;}
+	return found;
+}
+
+/* mark cell (iCol,iRow) as a new wave forehead with value waveValue if it's empty and unvisited */
+static inline void fpMarkFront(fp  *f, unsigned int iCol, unsigned int iRow, unsigned int waveValue) {
+	gridInd at=fpAt(f,iCol,iRow);
+	unsigned char *tag;
+	if (!FP_CELL_EMPTY(FP_MAP(f->cell,at))) return;
+	tag = fpWaveBlock(f,FP_BLOCK(at))+FP_BLOCK_OFF(at);	/* empty tiles get labelled anyway */
+	if (FP_WAVE_TYPE(*tag) == 'U') {
+		*tag = FP_WAVE_TAG(fpWaveCode('f'));
+		fpStoreWave(f,at,waveValue);
+		f->nxtFront[f->nxtFrontNum++] = (gridInd)iRow*f->col+iCol;
+	}
+}
+
 /* expand wave related to wire #wireNum from targer (targetX,targetY)        *
+ * only the current wave forehead cells (f->curFront) and their neighbors   *
+ * are visited, the new forehead is left in f->curFront for the next call   *
  * returns:- 0: wave is not expandable, 1: wave is expanded, 2: target found */
 int fpWaveExpand(fp  *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY) {
-	unsigned int srcX=f->srcX[wireNum];
-	unsigned int srcY=f->srcY[wireNum];
-	unsigned int iRow, iCol, rows=f->row, cols=f->col;
-	char	     waveType;
-	char	     cellType;
-	unsigned int val,expVal;
-	int expandable = 0;
+	unsigned int  cols=f->col;
+	unsigned int  x0=f->winX0, x1=f->winX1, y0=f->winY0, y1=f->winY1; /* search window */
+	gridInd      *front=f->curFront;
+	gridInd       frontNum=f->curFrontNum;
+	unsigned int  iCol, iRow;
+	gridInd       i, ind;
+	gridInd       finder=GRID_NONE; /* first forehead cell (row-major) touching a target */
+	unsigned int  tarX, tarY;
+	unsigned int  expVal=UINT_MAX;
+	int expandable = (frontNum > 0);
 	int found = 0;
+
+	/* find the first forehead cell in row-major order that touches a relevant target, *
+	 * so the same target is found as scanning the whole grid row by row               */
+	for (i=0;i<frontNum;i++) {
+		ind = front[i];
+		if ( (ind < finder) && fpTouchTarget(f,ind%cols,ind/cols,wireNum,&tarX,&tarY) ) {
+			finder = ind;
+			*targetX = tarX;
+			*targetY = tarY;
+			found = 1;
+		}
+	}
+
+	/* expand forehead; if target found, stop at the cell that found it as a grid scan does */
+	f->nxtFrontNum = 0;
+	fpGrowFront(&f->nxtFront,&f->nxtFrontCap,4*frontNum);	/* each cell opens 4 neighbors at most */
+	for (i=0;i<frontNum;i++) {
+		ind = front[i];
+		if (ind > finder) continue;
+		iCol = ind%cols;
+		iRow = ind/cols;
+		expVal = fpGetWaveValue(f,iCol,iRow);
+		f->visitCnt++;
+		if (iCol < x1) fpMarkFront(f,iCol+1,iRow,expVal+1); /*Avoid window boundary*/
+		if (iCol > x0) fpMarkFront(f,iCol-1,iRow,expVal+1); /*Avoid window boundary*/
+		if (iRow < y1) fpMarkFront(f,iCol,iRow+1,expVal+1); /*Avoid window boundary*/
+		if (iRow > y0) fpMarkFront(f,iCol,iRow-1,expVal+1); /*Avoid window boundary*/
+		fpSetWaveType(f,iCol,iRow,'V');
+	}
+
+	if (found) {
+		expVal = fpGetWaveValue(f,finder%cols,finder/cols);
+		fpSetWaveValue(f,*targetX,*targetY,expVal+1);
+		if (verbose) {printf("-I- Destination found at (%u,%u)\n",*targetX,*targetY);}
+		fpStep(steppingMode=='W',"Target found for source #%u",wireNum);
+	}
+
+	/* Move newly wave forehead tile to the next expansion iteration */
+	for (i=0;i<f->nxtFrontNum;i++) {
+		ind = f->nxtFront[i];
+		fpSetWaveType(f,ind%cols,ind/cols,'F');
+	}
+	fpSwapFront(f);
+
+	/* if wave expansion mode and not found, print wave expansion message */
+	fpStep((steppingMode=='W') && (!found),"Wave expansion #%u from source #%u",expVal+1,wireNum);
+
+	if (found == 1) return 2;
+	return expandable;
 	
-	for (iRow=0;iRow<rows;iRow++){
-		for (iCol=0;iCol<cols;iCol++){
-			waveType = fpGetWaveType(f,iCol,iRow);
-			if (waveType == 'F') {	/* if wave forehead -> explore */
-				expandable = 1;
-				expVal  = fpGetWaveValue(f,iCol,iRow);
-				if (iCol < cols-1) { /*Avoid boundary*/
-					cellType = fpGetCellType(f,iCol+1,iRow);
-					waveType = fpGetWaveType(f,iCol+1,iRow);
-					val	= fpGetCellValue(f,iCol+1,iRow);
-					if ( (cellType == 'E') && (waveType == 'U') ) {
-						fpSetWaveType(f,iCol+1,iRow,'f');
-						fpSetWaveValue(f,iCol+1,iRow,expVal+1);
-					} else if ( (cellType == 'T') && (val == wireNum) ) {
-						*targetX = iCol+1;
-						*targetY = iRow;
-						found = 1;
-					}
-				}
-				if (iCol > 0) { /*Avoid boundary*/
-					cellType = fpGetCellType(f,iCol-1,iRow);
-					waveType = fpGetWaveType(f,iCol-1,iRow);
-					val	= fpGetCellValue(f,iCol-1,iRow);
-					if ( (cellType == 'E') && (waveType == 'U') ) {
-						fpSetWaveType(f,iCol-1,iRow,'f');
-						fpSetWaveValue(f,iCol-1,iRow,expVal+1);
-					} else if ( (cellType == 'T') && (val == wireNum) ) {
-						*targetX = iCol-1;
-						*targetY = iRow;
-						found = 1;
-					}
-				}
-				if (iRow < rows-1) { /*Avoid boundary*/
-					cellType = fpGetCellType(f,iCol,iRow+1);
-					waveType = fpGetWaveType(f,iCol,iRow+1);
-					val	= fpGetCellValue(f,iCol,iRow+1);
-					if ( (cellType == 'E') && (waveType == 'U') ) {
-						fpSetWaveType(f,iCol,iRow+1,'f');
-						fpSetWaveValue(f,iCol,iRow+1,expVal+1);
-					} else if ( (cellType == 'T') && (val == wireNum) ) {
-						*targetX = iCol;
-						*targetY = iRow+1;
-						found = 1;
-					}
+}
+
+/* allocate bitboards and fill the empty tiles bitboard from the grid inside the routing region */
+static void fpCreateBB(fp  *f) {
+	unsigned int iRow, iCol;
+	f->bbPass   = bbCreate(f->col,f->row);
+	f->bbFront  = bbCreate(f->col,f->row);
+	f->bbNext   = bbCreate(f->col,f->row);
+	f->bbVisit  = bbCreate(f->col,f->row);
+	f->bbTarget = bbCreate(f->col,f->row);
+	f->bbRow0 = 1; f->bbRow1 = 0; /* empty */
+	f->bbVis0 = 1; f->bbVis1 = 0; /* empty */
+	if (verbose) printf("-I- Bitboard wave step kernel: %s\n",bbKernel());
+	for (iRow=f->regY0;iRow<=f->regY1;iRow++) {
+		for (iCol=f->regX0;iCol<=f->regX1;iCol++) {
+			if (fpGetCellType(f,iCol,iRow) == 'E') bbSet(f->bbPass,iCol,iRow);
+		}
+	}
+}
+
+/* fill bbVisit with the labelled tiles of the search window, bottom-up levels keep it up to date */
+static void fpDirVisitBB(fp  *f) {
+	unsigned int iRow, iCol, epoch=f->waveEpoch;
+	gridInd at;
+	bbClearRows(f->bbVisit,f->winY0,f->winY1);
+	for (iRow=f->winY0;iRow<=f->winY1;iRow++) {
+		for (iCol=f->winX0;iCol<=f->winX1;iCol++) {
+			at = fpAt(f,iCol,iRow);
+			if (FP_WAVE_TYPE(fpWaveTagAt(f,at)) != 'U') bbSet(f->bbVisit,iCol,iRow);
+		}
+	}
+	f->dirVisit = epoch;
+}
+
+/* direction-optimizing Lee-Moore expansion (-frontier): levels are expanded top-down by        *
+ * fpWaveExpand while the forehead is small. when the forehead times frontierAlpha exceeds the  *
+ * window tiles not labelled yet, levels are expanded bottom-up: all unvisited empty tiles of   *
+ * the search window next to the forehead are found at once by a bitboard step (bbDilate) over *
+ * the empty (bbPass) and labelled (bbVisit) tiles, then labelled in row-major order. the       *
+ * search turns top-down again when the forehead times frontierBeta is below the window area.  *
+ * labels, found target and returns are the same as of fpWaveExpand                             */
+int fpWaveExpandDir(fp  *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY) {
+	unsigned int  cols=f->col;
+	unsigned int  x0=f->winX0, x1=f->winX1, y0=f->winY0, y1=f->winY1; /* search window */
+	unsigned long long area=(unsigned long long)(x1-x0+1)*(y1-y0+1);
+	gridInd      *front=f->curFront;
+	gridInd       frontNum=f->curFrontNum;
+	unsigned int  epoch=f->waveEpoch;
+	unsigned int  iCol, iRow, w, row0, row1, nxt0, nxt1;
+	gridInd       i, ind;
+	gridInd       finder=GRID_NONE; /* first forehead cell (row-major) touching a target */
+	unsigned int  tarX, tarY;
+	unsigned int  expVal;
+	bbWord        bits;
+	int found = 0;
+	int res;
+
+	/* new search starts top-down, its forehead is labelled */
+	if (f->dirEpoch != epoch) {
+		f->dirEpoch = epoch;
+		f->dirBottomUp = 0;
+		f->dirLabel = frontNum;
+	}
+	if (frontNum == 0) return 0;
+
+	/* choose direction of this level */
+	if ( (!f->dirBottomUp) && ((unsigned long long)frontNum*frontierAlpha > area-MIN(area,f->dirLabel)) ) f->dirBottomUp = 1;
+	else if ( f->dirBottomUp && ((unsigned long long)frontNum*frontierBeta < area) )                     f->dirBottomUp = 0;
+
+	/* top-down */
+	if (!f->dirBottomUp) {
+		f->tdSteps++;
+		res = fpWaveExpand(f,wireNum,targetX,targetY);
+		f->dirLabel += f->curFrontNum;
+		if (f->dirVisit == epoch) {	/* keep bbVisit of earlier bottom-up levels up to date */
+			for (i=0;i<f->curFrontNum;i++) bbSet(f->bbVisit,f->curFront[i]%cols,f->curFront[i]/cols);
+		}
+		return res;
+	}
+
+	/* bottom-up: find the first forehead cell in row-major order that touches a target as fpWaveExpand */
+	f->buSteps++;
+	for (i=0;i<frontNum;i++) {
+		ind = front[i];
+		if ( (ind < finder) && fpTouchTarget(f,ind%cols,ind/cols,wireNum,&tarX,&tarY) ) {
+			finder = ind;
+			*targetX = tarX;
+			*targetY = tarY;
+			found = 1;
+		}
+	}
+	expVal = fpGetWaveValue(f,front[0]%cols,front[0]/cols);	/* level of the forehead */
+
+	/* unvisited empty tiles of the window next to the forehead (up to the finder) join the new forehead */
+	if (f->bbPass == NULL) fpCreateBB(f);
+	if (f->dirVisit != epoch) fpDirVisitBB(f);	/* first bottom-up level of this search */
+	row0 = y1; row1 = y0;
+	for (i=0;i<frontNum;i++) {
+		ind = front[i];
+		if (ind > finder) continue;
+		bbSet(f->bbFront,ind%cols,ind/cols);
+		row0 = MIN(row0,ind/cols);
+		row1 = MAX(row1,ind/cols);
+	}
+	f->nxtFrontNum = 0;
+	fpGrowFront(&f->nxtFront,&f->nxtFrontCap,4*frontNum);	/* each cell opens 4 neighbors at most */
+	if (row0 <= row1) {
+		nxt0 = (row0 > y0) ? row0-1 : y0;
+		nxt1 = (row1 < y1) ? row1+1 : y1;
+		bbDilate(f->bbNext,f->bbFront,f->bbPass,f->bbVisit,nxt0,nxt1,x0,x1);
+		for (iRow=nxt0;iRow<=nxt1;iRow++) {
+			for (w=x0>>6;w<=(x1>>6);w++) {
+				for (bits=bbRow(f->bbNext,iRow)[w];bits;bits&=bits-1) {	/* all set bits */
+					iCol = w*64+__builtin_ctzll(bits);
+					fpSetWaveType (f,iCol,iRow,'f');
+					fpSetWaveValue(f,iCol,iRow,expVal+1);
+					f->nxtFront[f->nxtFrontNum++] = (gridInd)iRow*cols+iCol;
 				}
-				if (iRow > 0) { /*Avoid boundary*/
-					cellType = fpGetCellType(f,iCol,iRow-1);
-					waveType = fpGetWaveType(f,iCol,iRow-1);
-					val	= fpGetCellValue(f,iCol,iRow-1);
-					if ( (cellType == 'E') && (waveType == 'U') ) {
-						fpSetWaveType(f,iCol,iRow-1,'f');
-						fpSetWaveValue(f,iCol,iRow-1,expVal+1);
-					} else if ( (cellType == 'T') && (val == wireNum) ) {
-						*targetX = iCol;
-						*targetY = iRow-1;
-						found = 1;
-					}
+			}
+		}
+		bbClearRows(f->bbFront,row0,row1);
+		bbClearRows(f->bbNext ,nxt0,nxt1);
+	}
+
+	/* forehead cells up to the finder are expanded */
+	for (i=0;i<frontNum;i++) {
+		ind = front[i];
+		if (ind > finder) continue;
+		f->visitCnt++;
+		fpSetWaveType(f,ind%cols,ind/cols,'V');
+	}
+
+	if (found) {
+		fpSetWaveValue(f,*targetX,*targetY,expVal+1);
+		if (verbose) {printf("-I- Destination found at (%u,%u)\n",*targetX,*targetY);}
+		fpStep(steppingMode=='W',"Target found for source #%u",wireNum);
+	}
+
+	/* Move newly wave forehead tile to the next expansion iteration */
+	for (i=0;i<f->nxtFrontNum;i++) {
+		ind = f->nxtFront[i];
+		fpSetWaveType(f,ind%cols,ind/cols,'F');
+	}
+	fpSwapFront(f);
+	f->dirLabel += f->curFrontNum;
+
+	/* if wave expansion mode and not found, print wave expansion message */
+	fpStep((steppingMode=='W') && (!found),"Wave expansion #%u from source #%u (bottom-up)",expVal+1,wireNum);
+
+	if (found) return 2;
+	return 1;
+}
+
+/* start a new search of wire #wireNum, the routed tree of the wire is the wave forehead */
+static void fpWaveSeed(fp  *f, unsigned int wireNum) {
+	unsigned int iRow, iCol, cols=f->col;
+	unsigned int val, run;
+	gridInd i;
+	char cellType;
+	if (f->treeWire != wireNum) {	/* tree is not tracked, collect it from the routing region */
+		fpAddTree(f,f->srcX[wireNum],f->srcY[wireNum],wireNum);
+		for (iRow=f->regY0;iRow<=f->regY1;iRow++){
+			for (iCol=f->regX0;iCol<=f->regX1;iCol++){
+				if ((run = fpEmptyRun(f,iCol,iRow)) > 0) {iCol += run-1; continue;}	/* empty */
+				val = fpGetCellValue(f,iCol,iRow);
+				cellType = fpGetCellType(f,iCol,iRow);
+				if ( ((cellType == 'w') && (val == wireNum)) ||     /* relevant wire          */
+	                 ((cellType == 't') && (val == wireNum))    ) { /* relevant routed target */
+					fpAddTree(f,iCol,iRow,wireNum);
 				}
+			}
+		}
+	}
+	fpNewWave(f);
+	for (i=0;i<f->treeNum;i++) {
+		iCol = f->treeCell[i]%cols;
+		iRow = f->treeCell[i]/cols;
+		fpAddFront(f,iCol,iRow);        /* set as wave forehead  */
+		fpSetWaveValue(f,iCol,iRow,0);  /* reset expansion value */
+	}
+}
+
+/* set forehead rows span to the rows of bitboard b that have any bit, within iRow0 to iRow1 */
+static void fpSpanBB(fp  *f, struct bbStr *b, unsigned int iRow0, unsigned int iRow1) {
+	unsigned int iRow, w;
+	int empty = 1;
+	bbWord any;
+	f->bbRow0 = 1; f->bbRow1 = 0; /* empty */
+	for (iRow=iRow0;iRow<=iRow1;iRow++) {
+		for (any=0,w=0;w<b->words;w++) any |= bbRow(b,iRow)[w];
+		if (any) {
+			if (empty) f->bbRow0 = iRow;
+			f->bbRow1 = iRow;
+			empty = 0;
+		}
+	}
+}
+
+/* set wave type (and value, unless UINT_MAX) of all tiles set in rows iRow0 to iRow1 of bitboard b *
+ * if span is 1, forehead rows span is set to the rows of b that have any bit (as fpSpanBB)         */
+static void fpMarkBB(fp  *f, struct bbStr *b, unsigned int iRow0, unsigned int iRow1,
+                             char waveType, unsigned int waveValue, int span) {
+	unsigned int iRow, w, iCol;
+	int empty = 1;
+	bbWord bits, any;
+	if (span) {f->bbRow0 = 1; f->bbRow1 = 0;} /* empty */
+	for (iRow=iRow0;iRow<=iRow1;iRow++) {
+		for (any=0,w=0;w<b->words;w++) {
+			any |= bbRow(b,iRow)[w];
+			for (bits=bbRow(b,iRow)[w];bits;bits&=bits-1) {	/* all set bits */
+				iCol = w*64+__builtin_ctzll(bits);
+				if (waveType == 'V') f->visitCnt++;
+				fpSetWaveType(f,iCol,iRow,waveType);
+				if (waveValue != UINT_MAX) fpSetWaveValue(f,iCol,iRow,waveValue);
+			}
+		}
+		if (span && any) {
+			if (empty) f->bbRow0 = iRow;
+			f->bbRow1 = iRow;
+			empty = 0;
+		}
+	}
+}
+
+/* bitboard version of fpWaveExpand: forehead, empty and visited tiles are kept as  *
+ * packed 64-tile words, one wave step is a few shift/or/and-not operations per word *
+ * wave values and types are recorded as in fpWaveExpand, hence fpTraceback works    *
+ * returns:- 0: wave is not expandable, 1: wave is expanded, 2: target found         */
+int fpWaveExpandBB(fp  *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY) {
+	unsigned int cols=f->col, rows=f->row;
+	unsigned int row0, row1, nxt0, nxt1;
+	unsigned int finX, finY;
+	gridInd i, ind;
+	struct bbStr *swp;
+	int found = 0;
+
+	if (f->bbPass == NULL) fpCreateBB(f);
+
+	/* new search: clear previous one, move forehead from curFront into bitboard, set targets */
+	if (f->bbEpoch != f->waveEpoch) {
+		bbClearRows(f->bbVisit,f->bbVis0,f->bbVis1);
+		bbClearRows(f->bbFront,f->bbRow0,f->bbRow1);
+		if (f->bbWire != UINT_MAX) {
+			for (i=0;i<f->dstNum[f->bbWire];i++) bbClr(f->bbTarget,f->dstX[f->bbWire][i],f->dstY[f->bbWire][i]);
+		}
+		for (i=0;i<f->dstNum[wireNum];i++) {
+			if (fpIsTarget(f,f->dstX[wireNum][i],f->dstY[wireNum][i],wireNum)) {
+				bbSet(f->bbTarget,f->dstX[wireNum][i],f->dstY[wireNum][i]);
+			}
+		}
+		for (i=0;i<f->curFrontNum;i++) {
+			ind = f->curFront[i];
+			bbSet(f->bbFront,ind%cols,ind/cols);
+		}
+		fpSpanBB(f,f->bbFront,0,rows-1);
+		f->bbVis0 = rows; f->bbVis1 = 0;
+		f->curFrontNum = 0;
+		f->bbWire  = wireNum;
+		f->bbLevel = 0;
+		f->bbEpoch = f->waveEpoch;
+	}
+	row0 = f->bbRow0;
+	row1 = f->bbRow1;
+	if (row0 > row1) return 0; /* empty forehead: not expandable */
+
+	/* first forehead tile in row-major order touching a relevant target; *
+	 * as fpWaveExpand, expand only forehead tiles up to it               */
+	if (bbFirstTouch(f->bbFront,f->bbTarget,row0,row1,&finX,&finY)) {
+		fpTouchTarget(f,finX,finY,wireNum,targetX,targetY);
+		bbClearAfter(f->bbFront,finX,finY,row1);
+		found = 1;
+	}
+
+	/* expand: next forehead rows are one row around the current one, inside the search window */
+	nxt0 = (row0 > f->winY0) ? row0-1 : f->winY0;
+	nxt1 = (row1 < f->winY1) ? row1+1 : f->winY1;
+	bbDilate(f->bbNext,f->bbFront,f->bbPass,f->bbVisit,nxt0,nxt1,f->winX0,f->winX1);
+	f->bbVis0 = MIN(f->bbVis0,nxt0);
+	f->bbVis1 = MAX(f->bbVis1,nxt1);
+
+	/* record wave types and values, then move to the next forehead */
+	fpMarkBB(f,f->bbFront,row0,row1,'V',UINT_MAX,0); /* also counts expanded tiles */
+	fpMarkBB(f,f->bbNext ,nxt0,nxt1,'F',f->bbLevel+1,1);
+	bbClearRows(f->bbFront,row0,row1);
+	swp = f->bbFront; f->bbFront = f->bbNext; f->bbNext = swp;
+	f->bbLevel++;
+
+	if (found) {
+		fpSetWaveValue(f,*targetX,*targetY,f->bbLevel);
+		if (verbose) {printf("-I- Destination found at (%u,%u)\n",*targetX,*targetY);}
+		fpStep(steppingMode=='W',"Target found for source #%u",wireNum);
+		return 2;
+	}
+	fpStep(steppingMode=='W',"Wave expansion #%u from source #%u",f->bbLevel,wireNum);
+	return 1;
+}
+
+/* Manhattan distance from (iCol,iRow) to the nearest target in f->hTarget, 0 if none. f->hSort is *
+ * scanned both ways from the major coordinate of the tile and stops where the major distance alone *
+ * reaches the nearest target found, hence high-fanout nets do not cost O(targets) per tile         */
+static inline unsigned int fpHeuristic(fp  *f, unsigned int iCol, unsigned int iRow) {
+	unsigned int major, minor, minorSize, dMajor, dist, minDist=UINT_MAX;
+	unsigned int lo=0, hi=f->hTargetNum, mid, j;
+	gridInd key;
+	if (f->hByRow) {major=iRow; minor=iCol; minorSize=f->col;}
+	else           {major=iCol; minor=iRow; minorSize=f->row;}
+	key = (gridInd)major*minorSize;
+	while (lo < hi) {	/* first target at or after the major coordinate */
+		mid = (lo+hi)/2;
+		if (f->hSort[mid] < key) lo = mid+1; else hi = mid;
+	}
+	for (j=lo;j<f->hTargetNum;j++) {
+		dMajor = (unsigned int)(f->hSort[j]/minorSize)-major;
+		if (dMajor >= minDist) break;
+		dist = dMajor + ABS((int)(f->hSort[j]%minorSize)-(int)minor);
+		if (dist < minDist) minDist = dist;
+	}
+	for (j=lo;j-->0;) {
+		dMajor = major-(unsigned int)(f->hSort[j]/minorSize);
+		if (dMajor >= minDist) break;
+		dist = dMajor + ABS((int)(f->hSort[j]%minorSize)-(int)minor);
+		if (dist < minDist) minDist = dist;
+	}
+	return (minDist == UINT_MAX) ? 0 : minDist;
+}
+
+/* ascending order of grid indices, for qsort */
+static int fpCompareInd(const void *a, const void *b) {
+	gridInd x=*(const gridInd*)a, y=*(const gridInd*)b;
+	return (x > y) - (x < y);
+}
+
+/* open tile (iCol,iRow) with wave value waveValue if it's empty and unvisited or reached by a *
+ * longer path; an unrouted target of wire #wireNum is queued with no distance to go          */
+static inline void fpOpenAStar(fp  *f, unsigned int iCol, unsigned int iRow, unsigned int waveValue, unsigned int wireNum) {
+	char waveType;
+	if (fpIsTarget(f,iCol,iRow,wireNum)) {
+		if (waveValue < fpGetWaveValue(f,iCol,iRow)) {
+			fpSetWaveValue(f,iCol,iRow,waveValue);
+			bqPush(f->bq,waveValue,(gridInd)iRow*f->col+iCol,waveValue);
+		}
+		return;
+	}
+	if (fpGetCellType(f,iCol,iRow) != 'E') return;
+	waveType = fpGetWaveType(f,iCol,iRow);
+	if ( (waveType == 'U') || ((waveType == 'F') && (waveValue < fpGetWaveValue(f,iCol,iRow))) ) {
+		fpSetWaveType (f,iCol,iRow,'F');
+		fpSetWaveValue(f,iCol,iRow,waveValue);
+		bqPush(f->bq,waveValue+fpHeuristic(f,iCol,iRow),(gridInd)iRow*f->col+iCol,waveValue);
+	}
+}
+
+/* collect the unrouted targets of wire #wireNum into f->hTarget, and sorted along the wider side *
+ * of their bounding box into f->hSort (for fpHeuristic)                                          */
+static void fpCollectTargets(fp  *f, unsigned int wireNum) {
+	unsigned int i, maxDst, x, y;
+	unsigned int x0=UINT_MAX, x1=0, y0=UINT_MAX, y1=0;
+	if (f->hTarget == NULL) {
+		for (i=0,maxDst=1;i<f->wireNum;i++) maxDst = MAX(maxDst,f->dstNum[i]); /* most targets of a wire */
+		f->hTarget = (gridInd*)safeMalloc(sizeof(gridInd)*maxDst);
+		f->hSort   = (gridInd*)safeMalloc(sizeof(gridInd)*maxDst);
+	}
+	f->hTargetNum = 0;
+	for (i=0;i<f->dstNum[wireNum];i++) {
+		x = f->dstX[wireNum][i];
+		y = f->dstY[wireNum][i];
+		if (fpIsTarget(f,x,y,wireNum)) {
+			f->hTarget[f->hTargetNum++] = (gridInd)y*f->col+x;
+			x0 = MIN(x0,x); x1 = MAX(x1,x);
+			y0 = MIN(y0,y); y1 = MAX(y1,y);
+		}
+	}
+	f->hByRow = (f->hTargetNum > 0) && (y1-y0 > x1-x0);
+	for (i=0;i<f->hTargetNum;i++) {
+		x = f->hTarget[i]%f->col;
+		y = f->hTarget[i]/f->col;
+		f->hSort[i] = f->hByRow ? (gridInd)y*f->col+x : (gridInd)x*f->row+y;
+	}
+	qsort(f->hSort,f->hTargetNum,sizeof(gridInd),fpCompareInd);
+}
+
+/* prepare bucket queue search of wire #wireNum (A*, Hadlock): on a new search collect the *
+ * unrouted targets into f->hTarget and move the forehead from curFront into the queue     */
+static void fpStartBQ(fp  *f, unsigned int wireNum) {
+	unsigned int cols=f->col;
+	gridInd i, ind;
+
+	if (f->bq == NULL) f->bq = bqCreate();
+
+	/* new search: collect unrouted targets, move forehead from curFront into the queue */
+	if (f->bqEpoch != f->waveEpoch) {
+		bqClear(f->bq);
+		fpCollectTargets(f,wireNum);
+		for (i=0;i<f->curFrontNum;i++) {
+			ind = f->curFront[i];
+			bqPush(f->bq,fpHeuristic(f,ind%cols,ind/cols),ind,0);
+		}
+		f->curFrontNum = 0;
+		f->bqBase  = bqMinKey(f->bq);
+		f->bqEpoch = f->waveEpoch;
+	}
+}
+
+/* goal-directed (A*) version of fpWaveExpand: open tiles are kept in a bucket queue by their   *
+ * wave value plus Manhattan distance to the nearest unrouted target, one call expands all open *
+ * tiles of the smallest key. paths are still shortest and fpTraceback works on visited tiles   *
+ * returns:- 0: wave is not expandable, 1: wave is expanded, 2: target found                    */
+int fpWaveExpandAStar(fp  *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY) {
+	unsigned int cols=f->col;
+	unsigned int key, minKey, val, iCol, iRow;
+	gridInd ind;
+
+	fpStartBQ(f,wireNum);
+	if (f->hTargetNum == 0) return 0;	/* no target to find */
+
+	/* expand all open tiles of the smallest key, including the ones opened meanwhile */
+	minKey = bqMinKey(f->bq);
+	if (minKey == UINT_MAX) return 0;	/* empty queue: not expandable */
+	while ( (bqMinKey(f->bq) == minKey) && bqPop(f->bq,&key,&ind,&val) ) {
+		iCol = ind%cols;
+		iRow = ind/cols;
+		if (val != fpGetWaveValue(f,iCol,iRow)) continue;	/* reached by a shorter path later */
+		if (fpIsTarget(f,iCol,iRow,wireNum)) {				/* nearest target */
+			*targetX = iCol;
+			*targetY = iRow;
+			if (verbose) {printf("-I- Destination found at (%u,%u)\n",*targetX,*targetY);}
+			fpStep(steppingMode=='W',"Target found for source #%u",wireNum);
+			return 2;
+		}
+		if (fpGetWaveType(f,iCol,iRow) != 'F') continue;	/* already expanded */
+		fpSetWaveType(f,iCol,iRow,'V');
+		f->visitCnt++;
+		if (iCol < f->winX1) fpOpenAStar(f,iCol+1,iRow,val+1,wireNum); /*Avoid window boundary*/
+		if (iCol > f->winX0) fpOpenAStar(f,iCol-1,iRow,val+1,wireNum); /*Avoid window boundary*/
+		if (iRow < f->winY1) fpOpenAStar(f,iCol,iRow+1,val+1,wireNum); /*Avoid window boundary*/
+		if (iRow > f->winY0) fpOpenAStar(f,iCol,iRow-1,val+1,wireNum); /*Avoid window boundary*/
+	}
+	fpStep(steppingMode=='W',"Wave expansion up to distance %u from source #%u",minKey,wireNum);
+	return 1;
+}
+
+/* push grid index ind on the Hadlock level stack (f->nxtFront) of *top cells */
+static inline void fpPushHadlock(fp  *f, gridInd ind, gridInd *top) {
+	if (*top == f->nxtFrontCap) fpGrowFront(&f->nxtFront,&f->nxtFrontCap,*top+1);
+	f->nxtFront[(*top)++] = ind;
+}
+
+/* open tile (iCol,iRow) for Hadlock's search at detour level 'level' with wave value waveValue *
+ * if it's empty and unvisited or reached by a longer path. zero detour moves (key stays at    *
+ * level) go on top of the level stack, others are queued for a later level                    */
+static inline void fpOpenHadlock(fp  *f, unsigned int iCol, unsigned int iRow, unsigned int waveValue,
+                                         unsigned int level, gridInd *top) {
+	unsigned int key;
+	char waveType;
+	if (fpGetCellType(f,iCol,iRow) != 'E') return;
+	waveType = fpGetWaveType(f,iCol,iRow);
+	if ( (waveType == 'U') || ((waveType == 'F') && (waveValue < fpGetWaveValue(f,iCol,iRow))) ) {
+		fpSetWaveType (f,iCol,iRow,'F');
+		fpSetWaveValue(f,iCol,iRow,waveValue);
+		key = waveValue+fpHeuristic(f,iCol,iRow);
+		if (key == level) fpPushHadlock(f,(gridInd)iRow*f->col+iCol,top);
+		else              bqPush(f->bq,key,(gridInd)iRow*f->col+iCol,waveValue);
+	}
+}
+
+/* Hadlock's minimum detour version of fpWaveExpand: a move toward the nearest unrouted target   *
+ * is free, a move away is a detour. tiles of the current detour level are kept on a stack whose *
+ * top takes the zero detour moves, hence the wave runs straight toward the target and turns    *
+ * around blockages; later levels wait in the bucket queue. one call expands one detour level.  *
+ * returns:- 0: wave is not expandable, 1: wave is expanded, 2: target found                     */
+int fpWaveExpandHadlock(fp  *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY) {
+	unsigned int cols=f->col;
+	gridInd top=0, ind;	/* f->nxtFront is the stack of the current detour level, unused otherwise */
+	unsigned int key, level, val, iCol, iRow;
+	int found = 0;
+
+	fpStartBQ(f,wireNum);
+	if (f->hTargetNum == 0) return 0;	/* no target to find */
+
+	/* move tiles of the smallest detour level from the queue to the level stack */
+	level = bqMinKey(f->bq);
+	if (level == UINT_MAX) return 0;	/* empty queue: not expandable */
+	while ( (bqMinKey(f->bq) == level) && bqPop(f->bq,&key,&ind,&val) ) {
+		if (val != fpGetWaveValue(f,ind%cols,ind/cols)) continue;	/* reached by a shorter path later */
+		if (fpGetWaveType(f,ind%cols,ind/cols) != 'F') continue;	/* already expanded */
+		fpPushHadlock(f,ind,&top);
+	}
+
+	/* expand level depth first; a target next to an expanded tile is reached without detour */
+	while ( (top > 0) && (!found) ) {
+		ind  = f->nxtFront[--top];
+		iCol = ind%cols;
+		iRow = ind/cols;
+		val  = fpGetWaveValue(f,iCol,iRow);
+		fpSetWaveType(f,iCol,iRow,'V');
+		f->visitCnt++;
+		if (fpTouchTarget(f,iCol,iRow,wireNum,targetX,targetY)) {
+			fpSetWaveValue(f,*targetX,*targetY,val+1);
+			found = 1;
+			break;
+		}
+		if (iCol < f->winX1) fpOpenHadlock(f,iCol+1,iRow,val+1,level,&top); /*Avoid window boundary*/
+		if (iCol > f->winX0) fpOpenHadlock(f,iCol-1,iRow,val+1,level,&top); /*Avoid window boundary*/
+		if (iRow < f->winY1) fpOpenHadlock(f,iCol,iRow+1,val+1,level,&top); /*Avoid window boundary*/
+		if (iRow > f->winY0) fpOpenHadlock(f,iCol,iRow-1,val+1,level,&top); /*Avoid window boundary*/
+	}
+
+	if (found) {
+		if (verbose) {printf("-I- Destination found at (%u,%u)\n",*targetX,*targetY);}
+		fpStep(steppingMode=='W',"Target found for source #%u",wireNum);
+		return 2;
+	}
+	fpStep(steppingMode=='W',"Wave expansion with detour %u from source #%u",level-f->bqBase,wireNum);
+	return 1;
+}
+
+/* line probe helper: try to step from tile ind toward (tarX,tarY) in direction dir (R,L,D,U), *
+ * returns the new tile index if the step gets closer and the tile is empty and unvisited,    *
+ * GRID_NONE otherwise                                                                        */
+static gridInd fpProbeStep(fp  *f, gridInd ind, char dir, unsigned int tarX, unsigned int tarY) {
+	unsigned int iCol=ind%f->col, iRow=ind/f->col;
+	switch (dir) {
+		case 'R': if (tarX > iCol) iCol++; else return GRID_NONE; break;
+		case 'L': if (tarX < iCol) iCol--; else return GRID_NONE; break;
+		case 'D': if (tarY > iRow) iRow++; else return GRID_NONE; break;
+		default : if (tarY < iRow) iRow--; else return GRID_NONE;
+	}
+	if ( (fpGetCellType(f,iCol,iRow) != 'E') || (fpGetWaveType(f,iCol,iRow) != 'U') ) return GRID_NONE;
+	return (gridInd)iRow*f->col+iCol;
+}
+
+/* Soukup's line probe search of wire #wireNum: from the tree tile nearest to an unrouted target, *
+ * probe depth first along straight lines toward the nearest target, keeping the direction while *
+ * it gets closer. when blocked, expand a breadth-first wave from the probe end until a tile      *
+ * closer to the target is reached, then probe again from it. visited tiles get wave values as a  *
+ * path from the tree, hence fpTraceback works, but paths are not always shortest.               *
+ * returns:- 0: probe is stuck (caller falls back to a wave search), 2: target found            */
+int fpWaveSoukup(fp  *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY) {
+	unsigned int cols=f->col;
+	unsigned int val, dist, minDist=UINT_MAX, iCol, iRow;
+	unsigned int tarX=0, tarY=0;
+	gridInd i, j, ind, nxt, cur=0, newNum, *front, frontNum;
+	char dir, *dirs;
+	int found = 0;
+
+	fpCollectTargets(f,wireNum);
+	if (f->hTargetNum == 0) return 0;
+
+	/* start from the tree tile nearest to any target (fpWaveSeed left the tree in curFront) */
+	for (i=0;i<f->curFrontNum;i++) {
+		dist = fpHeuristic(f,f->curFront[i]%cols,f->curFront[i]/cols);
+		if (dist < minDist) {minDist = dist; cur = f->curFront[i];}
+	}
+
+	while (!found) {
+
+		/* probe toward the target nearest to the probe, keep direction while possible */
+		for (minDist=UINT_MAX,i=0;i<f->hTargetNum;i++) {
+			dist = ABS((int)(f->hTarget[i]%cols)-(int)(cur%cols)) + ABS((int)(f->hTarget[i]/cols)-(int)(cur/cols));
+			if (dist < minDist) {minDist = dist; tarX = f->hTarget[i]%cols; tarY = f->hTarget[i]/cols;}
+		}
+		dir = (ABS((int)tarX-(int)(cur%cols)) >= ABS((int)tarY-(int)(cur/cols))) ? 'H' : 'V';
+		while (!(found = fpTouchTarget(f,cur%cols,cur/cols,wireNum,targetX,targetY))) {
+			dirs = (dir == 'H') ? "RLDU" : "DURL";	/* current direction first */
+			for (nxt=GRID_NONE,j=0;(j<4)&&(nxt==GRID_NONE);j++) nxt = fpProbeStep(f,cur,dirs[j],tarX,tarY);
+			if (nxt == GRID_NONE) break;				/* blocked */
+			dir = ((nxt == cur+1) || (nxt+1 == cur)) ? 'H' : 'V';
+			val = fpGetWaveValue(f,cur%cols,cur/cols);
+			fpSetWaveType (f,nxt%cols,nxt/cols,'V');
+			fpSetWaveValue(f,nxt%cols,nxt/cols,val+1);
+			f->visitCnt++;
+			cur = nxt;
+		}
+		fpStep((steppingMode=='W') && (!found),"Line probe of source #%u blocked at (%u,%u)",wireNum,cur%cols,cur/cols);
+		if (found) break;
+
+		/* blocked: breadth-first wave from the probe end until a tile closer to the target */
+		minDist = ABS((int)tarX-(int)(cur%cols)) + ABS((int)tarY-(int)(cur/cols));
+		front = f->curFront;
+		front[0] = cur;
+		frontNum = 1;
+		nxt = GRID_NONE;
+		while (1) {
+			f->nxtFrontNum = 0;
+			fpGrowFront(&f->nxtFront,&f->nxtFrontCap,4*frontNum);	/* each cell opens 4 neighbors at most */
+			for (i=0;(i<frontNum)&&(nxt==GRID_NONE);i++) {
+				ind  = front[i];
+				iCol = ind%cols;
+				iRow = ind/cols;
+				val  = fpGetWaveValue(f,iCol,iRow);
 				fpSetWaveType(f,iCol,iRow,'V');
-				if (found) {
-					fpSetWaveValue(f,*targetX,*targetY,expVal+1);
-					if (verbose) {printf("-I- Destination found at (%u,%u)\n",*targetX,*targetY);}
-					if (steppingMode=='W') {
-						sprintf(glabel,"Target found for source #%u",wireNum);
-						waitLoop();
-						if (psEnable) postscript(drawScreen);
-					}
+				f->visitCnt++;
+				if ((found = fpTouchTarget(f,iCol,iRow,wireNum,targetX,targetY))) {cur = ind; break;}
+				newNum = f->nxtFrontNum;
+				if (iCol < f->winX1) fpMarkFront(f,iCol+1,iRow,val+1); /*Avoid window boundary*/
+				if (iCol > f->winX0) fpMarkFront(f,iCol-1,iRow,val+1); /*Avoid window boundary*/
+				if (iRow < f->winY1) fpMarkFront(f,iCol,iRow+1,val+1); /*Avoid window boundary*/
+				if (iRow > f->winY0) fpMarkFront(f,iCol,iRow-1,val+1); /*Avoid window boundary*/
+				for (j=newNum;j<f->nxtFrontNum;j++) {	/* first new tile closer to the target */
+					ind = f->nxtFront[j];
+					if ((unsigned int)(ABS((int)tarX-(int)(ind%cols)) + ABS((int)tarY-(int)(ind/cols))) < minDist) {nxt = ind; break;}
 				}
-			} /* if 'F' */
+			}
+			if ( found || (nxt != GRID_NONE) || (f->nxtFrontNum == 0) ) break;
+			for (j=0;j<f->nxtFrontNum;j++) fpSetWaveType(f,f->nxtFront[j]%cols,f->nxtFront[j]/cols,'F');
+			fpSwapFront(f);
+			front = f->curFront;
+			frontNum = f->curFrontNum;
+		}
+
+		/* tiles left on the wave foreheads are released for later probes */
+		for (j=i;j<frontNum;j++) {
+			if (front[j] != cur) fpSetWaveType(f,front[j]%cols,front[j]/cols,'U');
+		}
+		for (j=0;j<f->nxtFrontNum;j++) {
+			if (f->nxtFront[j] != nxt) fpSetWaveType(f,f->nxtFront[j]%cols,f->nxtFront[j]/cols,'U');
+		}
+		f->curFrontNum = 0;
+		f->nxtFrontNum = 0;
 		if (found) break;
-		} /* for columns */
-	if (found) break;
-	} /* for raws */
+		if (nxt == GRID_NONE) return 0;	/* nothing closer is reachable */
+		fpSetWaveType(f,nxt%cols,nxt/cols,'V');
+		f->visitCnt++;
+		cur = nxt;
+		fpStep(steppingMode=='W',"Line probe of source #%u continues from (%u,%u)",wireNum,cur%cols,cur/cols);
+	}
 
-	/* Move newly wave forehead tile to the next expansion iteration */
-	for (iRow=0;iRow<rows;iRow++){
-		for (iCol=0;iCol<cols;iCol++){
-				if (fpGetWaveType(f,iCol,iRow) == 'f') {
-					fpSetWaveType(f,iCol,iRow,'F');
+	val = fpGetWaveValue(f,cur%cols,cur/cols);
+	fpSetWaveValue(f,*targetX,*targetY,val+1);
+	if (verbose) {printf("-I- Destination found at (%u,%u)\n",*targetX,*targetY);}
+	fpStep(steppingMode=='W',"Target found for source #%u",wireNum);
+	return 2;
+}
+
+/* nearest unrouted target of wire #wireNum to its source (Manhattan distance)  *
+ * returns:- 0: no unrouted target, 1: nearest target is at (*tarX,*tarY)       */
+static int fpNearestTarget(fp  *f, unsigned int wireNum, unsigned int *tarX, unsigned int *tarY) {
+	unsigned int i, dist, minDist=UINT_MAX;
+	unsigned int srcX=f->srcX[wireNum], srcY=f->srcY[wireNum];
+	for (i=0;i<f->dstNum[wireNum];i++) {
+		if (!fpIsTarget(f,f->dstX[wireNum][i],f->dstY[wireNum][i],wireNum)) continue;
+		dist = ABS((int)f->dstX[wireNum][i]-(int)srcX) + ABS((int)f->dstY[wireNum][i]-(int)srcY);
+		if (dist < minDist) {
+			minDist = dist;
+			*tarX = f->dstX[wireNum][i];
+			*tarY = f->dstY[wireNum][i];
+		}
+	}
+	return (minDist != UINT_MAX);
+}
+
+/* expand one level of a two-way search wave: forward (back=0, F:forehead, V:visited) or *
+ * backward (back=1, R:forehead, r:visited). cells of the other wave around the forehead *
+ * are meetings, the shortest one is kept in *meetLen, *meetFw (forward cell index) and  *
+ * *meetBk (backward cell index). returns the number of new forehead cells in next       */
+static gridInd fpTwoWayLevel(fp  *f, gridInd *front, gridInd frontNum, gridInd *next, int back,
+                                     unsigned int *meetLen, gridInd *meetFw, gridInd *meetBk) {
+	unsigned int cols=f->col;
+	unsigned int j, iCol, iRow, val, len;
+	gridInd i, ind, nbr, nextNum=0;
+	gridInd nbrInd[4];
+	unsigned int nbrNum;
+	char waveType;
+	for (i=0;i<frontNum;i++) {
+		ind  = front[i];
+		iCol = ind%cols;
+		iRow = ind/cols;
+		val  = fpGetWaveValue(f,iCol,iRow);
+		nbrNum = 0;                    /* neighbors in right, left, down, up order, inside the window */
+		if (iCol < f->winX1) nbrInd[nbrNum++] = ind+1;
+		if (iCol > f->winX0) nbrInd[nbrNum++] = ind-1;
+		if (iRow < f->winY1) nbrInd[nbrNum++] = ind+cols;
+		if (iRow > f->winY0) nbrInd[nbrNum++] = ind-cols;
+		for (j=0;j<nbrNum;j++) {
+			nbr = nbrInd[j];
+			waveType = fpGetWaveType(f,nbr%cols,nbr/cols);
+			if ( back ? ((waveType == 'F') || (waveType == 'V'))     /* meet the other wave */
+			          : ((waveType == 'R') || (waveType == 'r')) ) {
+				len = val + 1 + fpGetWaveValue(f,nbr%cols,nbr/cols);
+				if (len < *meetLen) {
+					*meetLen = len;
+					*meetFw  = back ? nbr : ind;
+					*meetBk  = back ? ind : nbr;
 				}
+			} else if ( (fpGetCellType(f,nbr%cols,nbr/cols) == 'E') && (waveType == 'U') ) {
+				fpSetWaveType (f,nbr%cols,nbr/cols,back ? 'R' : 'F');
+				fpSetWaveValue(f,nbr%cols,nbr/cols,val+1);
+				next[nextNum++] = nbr;
+			}
 		}
+		fpSetWaveType(f,iCol,iRow,back ? 'r' : 'V');
+		f->visitCnt++;
 	}
+	return nextNum;
+}
 
-	/* if wave expansion mode and not found, print wave expansion message */
-	if ((steppingMode=='W') && (!found)) {	
-		sprintf(glabel,"Wave expansion #%u from source #%u",expVal+1,wireNum);
-		waitLoop();
-		if (psEnable) postscript(drawScreen);
+/* two-way search from the current forehead (routed tree) of wire #wireNum and from its     *
+ * nearest unrouted target (Manhattan distance), the smaller forehead is expanded each step. *
+ * when the waves meet, the backward part of a shortest path gets forward wave values,      *
+ * hence fpTraceback works. returns:- 0: waves have not met, 2: target found                 */
+int fpWaveTwoWay(fp  *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY) {
+	unsigned int cols=f->col;
+	unsigned int tarX, tarY, iCol, iRow, val;
+	unsigned int meetLen=UINT_MAX;
+	gridInd ind, meetFw=0, meetBk=0, cap;
+	unsigned long long visited=f->visitCnt;
+	gridInd *swp;
+
+	if (!fpNearestTarget(f,wireNum,&tarX,&tarY)) return 0;
+	if (f->bkFront == NULL) {	/* grown as the backward wave does */
+		f->bkFront = (gridInd*)safeMalloc(sizeof(gridInd)*FP_FRONT_MIN);
+		f->bkNext  = (gridInd*)safeMalloc(sizeof(gridInd)*FP_FRONT_MIN);
+		f->bkFrontCap = FP_FRONT_MIN;
+		f->bkNextCap  = FP_FRONT_MIN;
 	}
 
-	if (found == 1) return 2;
-	return expandable;
-	
+	/* backward wave starts from the target, forward wave from the forehead set by fpWaveSeed */
+	fpSetWaveType (f,tarX,tarY,'R');
+	fpSetWaveValue(f,tarX,tarY,0);
+	f->bkFront[0] = (gridInd)tarY*cols+tarX;
+	f->bkFrontNum = 1;
+
+	/* expand the smaller forehead by one level until the waves meet or one of them is stuck */
+	while ( (meetLen == UINT_MAX) && (f->curFrontNum > 0) && (f->bkFrontNum > 0) ) {
+		if (f->curFrontNum <= f->bkFrontNum) {
+			fpGrowFront(&f->nxtFront,&f->nxtFrontCap,4*f->curFrontNum);	/* each cell opens 4 neighbors at most */
+			f->nxtFrontNum = fpTwoWayLevel(f,f->curFront,f->curFrontNum,f->nxtFront,0,&meetLen,&meetFw,&meetBk);
+			fpSwapFront(f);
+			fpStep(steppingMode=='W',"Forward wave expansion from source #%u",wireNum);
+		} else {
+			fpGrowFront(&f->bkNext,&f->bkNextCap,4*f->bkFrontNum);
+			f->bkNextNum = fpTwoWayLevel(f,f->bkFront,f->bkFrontNum,f->bkNext,1,&meetLen,&meetFw,&meetBk);
+			swp = f->bkFront; f->bkFront = f->bkNext; f->bkNext = swp;
+			cap = f->bkFrontCap; f->bkFrontCap = f->bkNextCap; f->bkNextCap = cap;
+			f->bkFrontNum = f->bkNextNum;
+			f->bkNextNum = 0;
+			fpStep(steppingMode=='W',"Backward wave expansion from target (%u,%u)",tarX,tarY);
+		}
+	}
+	if (verbose) printf("-I- Two-way search expanded %llu tiles\n",f->visitCnt-visited);
+	if (meetLen == UINT_MAX) return 0;
+
+	/* relabel the backward path from the meeting cell to the target with forward values */
+	if (fpGetWaveType(f,meetFw%cols,meetFw/cols) == 'F') fpSetWaveType(f,meetFw%cols,meetFw/cols,'V');
+	for (ind=meetBk;;) {
+		iCol = ind%cols;
+		iRow = ind/cols;
+		val  = fpGetWaveValue(f,iCol,iRow);
+		fpSetWaveValue(f,iCol,iRow,meetLen-val);
+		if (val == 0) break;	/* target reached */
+		fpSetWaveType(f,iCol,iRow,'V');
+		if      ( (iCol < cols-1  ) && (toupper(fpGetWaveType(f,iCol+1,iRow)) == 'R') && (fpGetWaveValue(f,iCol+1,iRow) == val-1) ) ind = ind+1;
+		else if ( (iCol > 0       ) && (toupper(fpGetWaveType(f,iCol-1,iRow)) == 'R') && (fpGetWaveValue(f,iCol-1,iRow) == val-1) ) ind = ind-1;
+		else if ( (iRow < f->row-1) && (toupper(fpGetWaveType(f,iCol,iRow+1)) == 'R') && (fpGetWaveValue(f,iCol,iRow+1) == val-1) ) ind = ind+cols;
+		else                                                                                                                          ind = ind-cols;
+	}
+
+	*targetX = tarX;
+	*targetY = tarY;
+	if (verbose) {printf("-I- Destination found at (%u,%u)\n",*targetX,*targetY);}
+	fpStep(steppingMode=='W',"Target found for source #%u",wireNum);
+	return 2;
+}
+
+/* lower wave value of cell (iCol,iRow) to waveValue and queue it in f->bq if it's empty and *
+ * unvisited or has a larger value (decrease-only update of fpWaveIncremental)               */
+static inline void fpLowerFront(fp  *f, unsigned int iCol, unsigned int iRow, unsigned int waveValue) {
+	if ( (fpGetCellType(f,iCol,iRow) == 'E') &&
+	     ((fpGetWaveType(f,iCol,iRow) == 'U') || (waveValue < fpGetWaveValue(f,iCol,iRow))) ) {
+		fpSetWaveType (f,iCol,iRow,'F');
+		fpSetWaveValue(f,iCol,iRow,waveValue);
+		bqPush(f->bq,waveValue,(gridInd)iRow*f->col+iCol,waveValue);
+	}
+}
+
+/* incremental Lee-Moore search of wire #wireNum: the distance field from the routed tree and *
+ * its open cells (f->bq) are kept between the targets of the wire. a search expands cells in *
+ * distance order only up to the nearest unrouted target; the next one seeds the tree cells   *
+ * added by the last traceback with distance 0 and continues, a cell is queued again only if  *
+ * it gets a shorter distance (decrease-only repair). the target is chosen as fpWaveExpand    *
+ * would choose it. returns:- 0: no target is reachable, 2: target found                      */
+int fpWaveIncremental(fp  *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY) {
+	unsigned int  cols=f->col, rows=f->row;
+	unsigned int  x0=f->winX0, x1=f->winX1, y0=f->winY0, y1=f->winY1; /* search window */
+	unsigned int  j, key, iCol, iRow, val, tarX, tarY;
+	gridInd       i, ind;
+	unsigned int  minDist=UINT_MAX;
+	gridInd       finder=GRID_NONE; /* first forehead cell (row-major) touching a nearest target */
+	gridInd       nbrInd[4];
+	unsigned int  nbrNum;
+	unsigned long long visited=f->visitCnt;
+	int repair;
+
+	if (f->bq == NULL) f->bq = bqCreate();
+
+	/* the field is kept if it belongs to this wire and search window and nothing reset the wave */
+	repair = (f->incWire == wireNum) && (f->incEpoch == f->waveEpoch) && (f->treeWire == wireNum) &&
+	         (f->incX0 == x0) && (f->incX1 == x1) && (f->incY0 == y0) && (f->incY1 == y1);
+	if (repair) {	/* new tree cells (last traced path and target) are opened with distance 0 */
+		for (i=0;i<f->incHoldNum;i++) fpSetWaveType(f,f->incHold[i]%cols,f->incHold[i]/cols,'V');
+		for (i=f->incTree;i<f->treeNum;i++) {
+			fpSetWaveType (f,f->treeCell[i]%cols,f->treeCell[i]/cols,'F');
+			fpSetWaveValue(f,f->treeCell[i]%cols,f->treeCell[i]/cols,0);
+			bqPush(f->bq,0,f->treeCell[i],0);
+		}
+
+		/* unrouted targets next to cells expanded by earlier searches */
+		for (i=0;i<f->dstNum[wireNum];i++) {
+			tarX = f->dstX[wireNum][i];
+			tarY = f->dstY[wireNum][i];
+			if (!fpIsTarget(f,tarX,tarY,wireNum)) continue;
+			nbrNum = 0;
+			if (tarX < cols-1) nbrInd[nbrNum++] = (gridInd)tarY*cols+tarX+1;
+			if (tarX > 0     ) nbrInd[nbrNum++] = (gridInd)tarY*cols+tarX-1;
+			if (tarY < rows-1) nbrInd[nbrNum++] = (gridInd)(tarY+1)*cols+tarX;
+			if (tarY > 0     ) nbrInd[nbrNum++] = (gridInd)(tarY-1)*cols+tarX;
+			for (j=0;j<nbrNum;j++) {
+				ind = nbrInd[j];
+				if (fpGetWaveType(f,ind%cols,ind/cols) != 'V') continue;	/* not expanded */
+				val = fpGetWaveValue(f,ind%cols,ind/cols)+1;
+				if ( (val < minDist) || ((val == minDist) && (ind < finder)) ) {minDist = val; finder = ind;}
+			}
+		}
+	} else {		/* new field: the whole tree is opened with distance 0 */
+		fpWaveSeed(f,wireNum);
+		bqClear(f->bq);
+		for (i=0;i<f->curFrontNum;i++) bqPush(f->bq,0,f->curFront[i],0);
+		f->curFrontNum = 0;
+		f->incWire  = wireNum;
+		f->incEpoch = f->waveEpoch;
+		f->incX0 = x0; f->incX1 = x1;
+		f->incY0 = y0; f->incY1 = y1;
+	}
+	f->incTree = f->treeNum;
+	f->incHoldNum = 0;
+
+	/* expand open cells in distance order until all cells before the nearest target are expanded; *
+	 * a target is as near as the cells around it are, the finder is the first one in row-major order */
+	while ( (bqMinKey(f->bq) < minDist) && bqPop(f->bq,&key,&ind,&val) ) {
+		iCol = ind%cols;
+		iRow = ind/cols;
+		if ( (val != fpGetWaveValue(f,iCol,iRow)) || (fpGetWaveType(f,iCol,iRow) != 'F') ) continue; /* stale */
+		fpSetWaveType(f,iCol,iRow,'V');
+		f->visitCnt++;
+		if ( fpTouchTarget(f,iCol,iRow,wireNum,&tarX,&tarY) &&
+		     ((val+1 < minDist) || ((val+1 == minDist) && (ind < finder))) ) {minDist = val+1; finder = ind;}
+		if (iCol < x1) fpLowerFront(f,iCol+1,iRow,val+1); /*Avoid window boundary*/
+		if (iCol > x0) fpLowerFront(f,iCol-1,iRow,val+1); /*Avoid window boundary*/
+		if (iRow < y1) fpLowerFront(f,iCol,iRow+1,val+1); /*Avoid window boundary*/
+		if (iRow > y0) fpLowerFront(f,iCol,iRow-1,val+1); /*Avoid window boundary*/
+	}
+	if (verbose) printf("-I- Incremental search %s %llu tiles\n",repair ? "repaired" : "expanded",f->visitCnt-visited);
+	fpStep(steppingMode=='W',"Wave %s from source #%u",repair ? "repaired" : "expanded",wireNum);
+	if (finder == GRID_NONE) return 0;	/* no target is reachable */
+
+	fpTouchTarget(f,finder%cols,finder/cols,wireNum,targetX,targetY);
+	fpSetWaveValue(f,*targetX,*targetY,minDist);
+
+	/* fpWaveExpand stops at the finder, the forehead cells after it are not visited yet; *
+	 * hide the ones around the target from traceback until the next repair               */
+	tarX = *targetX;
+	tarY = *targetY;
+	nbrNum = 0;
+	if (tarX < cols-1) nbrInd[nbrNum++] = (gridInd)tarY*cols+tarX+1;
+	if (tarX > 0     ) nbrInd[nbrNum++] = (gridInd)tarY*cols+tarX-1;
+	if (tarY < rows-1) nbrInd[nbrNum++] = (gridInd)(tarY+1)*cols+tarX;
+	if (tarY > 0     ) nbrInd[nbrNum++] = (gridInd)(tarY-1)*cols+tarX;
+	for (j=0;j<nbrNum;j++) {
+		ind = nbrInd[j];
+		if ( (ind > finder) && (fpGetCellType(f,ind%cols,ind/cols) == 'E') && (fpGetWaveType(f,ind%cols,ind/cols) == 'V') &&
+		     (fpGetWaveValue(f,ind%cols,ind/cols) == minDist-1) ) {
+			fpSetWaveType(f,ind%cols,ind/cols,'F');
+			f->incHold[f->incHoldNum++] = ind;
+		}
+	}
+
+	if (verbose) {printf("-I- Destination found at (%u,%u)\n",*targetX,*targetY);}
+	fpStep(steppingMode=='W',"Target found for source #%u",wireNum);
+	return 2;
+}
+
+/* check the wave of the current search against a Lee-Moore search (fpWaveExpand) from    *
+ * the same forehead. expRes and (tarX,tarY) are the results of the checked engine.       *
+ * bitboard waves must match tile by tile; A* and Hadlock must find a target at the same  *
+ * distance and their visited tiles must have Lee-Moore values (shortest distances) where *
+ * Lee-Moore has any. searches label the search window only, which is compared. the     *
+ * checked wave is restored for traceback. returns mismatches                             */
+unsigned int fpWaveCheck(fp  *f, unsigned int wireNum, int expRes, unsigned int tarX, unsigned int tarY) {
+	unsigned int  iRow, iCol, x0=f->winX0, x1=f->winX1, y0=f->winY0, y1=f->winY1; /* search window */
+	unsigned int  cols=x1-x0+1, leeX=0, leeY=0, errNum=0;
+	size_t        area=(size_t)(y1-y0+1)*cols, k;
+	unsigned int *chkValue = (unsigned int*)safeMalloc(sizeof(unsigned int)*area); /* window copies are not */
+	char         *chkType  = (char*        )safeMalloc(sizeof(char        )*area); /* per-wire scratch      */
+	char          chkStepping = steppingMode;
+	int           chkVerbose  = verbose;
+	int           exact = (searchMode == 'B') || (searchMode == 'P') || /* engine labels tiles as Lee-Moore does */
+	                      ((searchMode == 'L') && frontierAlpha);
+	unsigned int  chkLen = (expRes == 2) ? fpGetWaveValue(f,tarX,tarY) : UINT_MAX;
+	unsigned long long chkVisit = f->visitCnt; /* check is not counted in statistics */
+	int           leeRes = 1;
+
+	/* keep checked wave */
+	for (iRow=y0;iRow<=y1;iRow++) {
+		for (iCol=x0,k=(size_t)(iRow-y0)*cols;iCol<=x1;iCol++,k++) {
+			chkValue[k] = fpGetWaveValue(f,iCol,iRow);
+			chkType [k] = fpGetWaveType (f,iCol,iRow);
+		}
+	}
+
+	/* quiet Lee-Moore search from the same forehead */
+	steppingMode = 'R';
+	verbose = 0;
+	fpWaveSeed(f,wireNum);
+	while (leeRes == 1) leeRes = fpWaveExpand(f,wireNum,&leeX,&leeY);
+	steppingMode = chkStepping;
+	verbose = chkVerbose;
+	f->visitCnt = chkVisit;
+
+	/* compare */
+	if ( (leeRes != expRes) || ((leeRes == 2) && exact && ((leeX != tarX) || (leeY != tarY)))
+	                        || ((leeRes == 2) && (fpGetWaveValue(f,leeX,leeY) != chkLen)) ) {
+		printf("-E- Wave check: wire #%u search result %d target (%u,%u), Lee-Moore %d target (%u,%u)\n",
+		       wireNum,expRes,tarX,tarY,leeRes,leeX,leeY);
+		errNum++;
+	}
+	for (iRow=y0;iRow<=y1;iRow++) {
+		for (iCol=x0,k=(size_t)(iRow-y0)*cols;iCol<=x1;iCol++,k++) {
+			if ( exact ? ( (chkValue[k] != fpGetWaveValue(f,iCol,iRow)) ||
+			               (chkType [k] != fpGetWaveType (f,iCol,iRow))    )
+			           : ( (chkType [k] == 'V') && (fpGetWaveType(f,iCol,iRow) != 'U') &&
+			               (chkValue[k] != fpGetWaveValue(f,iCol,iRow))    ) ) {
+				if (errNum < 10) printf("-E- Wave check: wire #%u tile (%u,%u) is %c%u, Lee-Moore %c%u\n",wireNum,iCol,iRow,
+				                        chkType[k],chkValue[k],fpGetWaveType(f,iCol,iRow),fpGetWaveValue(f,iCol,iRow));
+				errNum++;
+			}
+		}
+	}
+	if (verbose) printf("-I- Wave check: wire #%u, %u mismatches\n",wireNum,errNum);
+
+	/* restore checked wave, Lee-Moore may have stopped at another target */
+	for (iRow=y0;iRow<=y1;iRow++) {
+		for (iCol=x0,k=(size_t)(iRow-y0)*cols;iCol<=x1;iCol++,k++) {
+			fpSetWaveType (f,iCol,iRow,chkType [k]);
+			fpSetWaveValue(f,iCol,iRow,chkValue[k]);
+		}
+	}
+
+	safeFree(chkValue);
+	safeFree(chkType);
+	return errNum;
+}
+
+/* set the search window of wire #wireNum to the bounding box of its pins and routed tree     *
+ * (f->treeCell) widened by margin tiles on each side and clipped to the routing region; a   *
+ * negative margin sets the whole region. returns 1 if the window is smaller than the region *
+ * (the grid unless routed by fpRouteWireRegion), 0 otherwise                                */
+int fpSetWindow(fp  *f, unsigned int wireNum, int margin) {
+	unsigned int cols=f->col, m;
+	gridInd i;
+	unsigned int x0=f->srcX[wireNum], x1=x0, y0=f->srcY[wireNum], y1=y0;
+	if (margin < 0) {
+		f->winX0 = f->regX0; f->winX1 = f->regX1;
+		f->winY0 = f->regY0; f->winY1 = f->regY1;
+		return 0;
+	}
+	m = (unsigned int)margin;
+	for (i=0;i<f->dstNum[wireNum];i++) {
+		x0 = MIN(x0,f->dstX[wireNum][i]); x1 = MAX(x1,f->dstX[wireNum][i]);
+		y0 = MIN(y0,f->dstY[wireNum][i]); y1 = MAX(y1,f->dstY[wireNum][i]);
+	}
+	for (i=0;i<f->treeNum;i++) {
+		x0 = MIN(x0,(unsigned int)(f->treeCell[i]%cols)); x1 = MAX(x1,(unsigned int)(f->treeCell[i]%cols));
+		y0 = MIN(y0,(unsigned int)(f->treeCell[i]/cols)); y1 = MAX(y1,(unsigned int)(f->treeCell[i]/cols));
+	}
+	/* differences, not sums, hence no overflow near the grid end */
+	f->winX0 = ((x0 > f->regX0) && (x0-f->regX0 > m)) ? x0-m : f->regX0;
+	f->winY0 = ((y0 > f->regY0) && (y0-f->regY0 > m)) ? y0-m : f->regY0;
+	f->winX1 = ((x1 < f->regX1) && (f->regX1-x1 > m)) ? x1+m : f->regX1;
+	f->winY1 = ((y1 < f->regY1) && (f->regY1-y1 > m)) ? y1+m : f->regY1;
+	return (f->winX0 > f->regX0) || (f->winY0 > f->regY0) || (f->winX1 < f->regX1) || (f->winY1 < f->regY1);
+}
+
+/* check if the wave of a failed search reached the search window border next to an empty tile *
+ * out of the window, hence a wider window may find a target. returns 1 if so, 0 otherwise     */
+static int fpWindowLeak(fp  *f) {
+	unsigned int i, x0=f->winX0, x1=f->winX1, y0=f->winY0, y1=f->winY1;
+	for (i=y0;i<=y1;i++) {	/* left and right borders */
+		if ( (x0 > f->regX0) && (fpGetWaveType(f,x0,i) == 'V') && (fpGetCellType(f,x0-1,i) == 'E') ) return 1;
+		if ( (x1 < f->regX1) && (fpGetWaveType(f,x1,i) == 'V') && (fpGetCellType(f,x1+1,i) == 'E') ) return 1;
+	}
+	for (i=x0;i<=x1;i++) {	/* top and bottom borders */
+		if ( (y0 > f->regY0) && (fpGetWaveType(f,i,y0) == 'V') && (fpGetCellType(f,i,y0-1) == 'E') ) return 1;
+		if ( (y1 < f->regY1) && (fpGetWaveType(f,i,y1) == 'V') && (fpGetCellType(f,i,y1+1) == 'E') ) return 1;
+	}
+	return 0;
 }
 
 /* route wire #wireNum to any avaliable unrouted target            *
@@ -606,38 +2036,61 @@ int fpWaveExpand(fp  *f,unsigned int wireNum, unsigned int *targetX, unsigned in
 int fpRouteDestination(fp  *f, unsigned int wireNum) {
 	unsigned int srcX=f->srcX[wireNum];
 	unsigned int srcY=f->srcY[wireNum];
-	unsigned int iRow, iCol, rows=f->row, cols=f->col;
-	char cellType, waveType;
-	unsigned int val;
-	unsigned int targetX,targetY;
-	unsigned int i;
-	int expRes = 1;
+	unsigned int targetX=0,targetY=0;
+	int expRes;
+	int met;		/* target found by two-way search or line probes, not by a wave engine */
+	int margin=winMargin;
+	int windowed;	/* search window is smaller than the grid */
 	int ret=0;
 
-	/* initialize before route */
-	for (iRow=0;iRow<rows;iRow++){
-		for (iCol=0;iCol<cols;iCol++){
-			val = fpGetCellValue(f,iCol,iRow);
-			cellType = fpGetCellType(f,iCol,iRow);
-			waveType = fpGetWaveType(f,iCol,iRow); 
-			if ( ((cellType == 'S') && (val == wireNum)) ||     /* if relevant source        */
-				 ((cellType == 'w') && (val == wireNum)) ||     /* or relevant wire          */
-                 ((cellType == 't') && (val == wireNum))    ) { /* or relevant routed target */
-				fpSetWaveType(f,iCol,iRow,'F');           		/* set as wave forehead      */
-				fpSetWaveValue(f,iCol,iRow,0);		            /* reset expansion value     */
+	do {
+		/* initialize before route: new search, routed tree of the wire is the wave forehead *
+		 * (incremental search keeps its distance field unless the tree is not tracked)      */
+		if ((!incremental) || (f->treeWire != wireNum)) fpWaveSeed(f,wireNum);
+		windowed = fpSetWindow(f,wireNum,margin);
+		expRes = incremental ? fpWaveIncremental(f,wireNum,&targetX,&targetY) : 1;
+		met = 0;
+
+		/* first target of the wire (tree is the source only): two-way search to the nearest target *
+		 * if the waves have not met, search all targets from the source                           */
+		if (twoWay && (f->treeNum == 1) && (expRes == 1)) {
+			met = (fpWaveTwoWay(f,wireNum,&targetX,&targetY) == 2);
+			if (met) expRes = 2;
+			else     fpWaveSeed(f,wireNum);
+		}
 
-			} else {	/* set to unvisited */
-				fpSetWaveType(f,iCol,iRow,'U');
-				fpSetWaveValue(f,iCol,iRow,UINT_MAX); 
-			}			
+		/* Soukup: line probes first, if stuck search all targets with Lee-Moore expansion */
+		if ((!met) && (searchMode == 'S') && (expRes == 1)) {
+			met = (fpWaveSoukup(f,wireNum,&targetX,&targetY) == 2);
+			if (met) expRes = 2;
+			else     fpWaveSeed(f,wireNum);
 		}
-	}
-	for(i=0;i<(f->wireNum);i++) {f->ripCnt[i] = 0;} /* reset rip-up counter*/
 
-	/* while expandable and target not found, expand */
-	while (expRes == 1) {
-		expRes = fpWaveExpand(f,wireNum,&targetX,&targetY);
-	}
+		/* while expandable and target not found, expand */
+		while (expRes == 1) {
+			switch (searchMode) {
+				case 'B': expRes = fpWaveExpandBB     (f,wireNum,&targetX,&targetY); break; /* bitboard  */
+				case 'A': expRes = fpWaveExpandAStar  (f,wireNum,&targetX,&targetY); break; /* A*        */
+				case 'H': expRes = fpWaveExpandHadlock(f,wireNum,&targetX,&targetY); break; /* Hadlock   */
+				case 'P': expRes = parWaveExpand      (f,wireNum,&targetX,&targetY,jobs); break; /* parallel  */
+				default : expRes = frontierAlpha ?                                            /* Lee-Moore */
+				                   fpWaveExpandDir    (f,wireNum,&targetX,&targetY) :
+				                   fpWaveExpand       (f,wireNum,&targetX,&targetY);
+			}
+		}
+		if (checkMode && ((searchMode != 'L') || incremental || frontierAlpha) && (searchMode != 'S') && (!met)) {
+			fpWaveCheck(f,wireNum,expRes,targetX,targetY);
+			if (incremental) f->incEpoch = f->waveEpoch;	/* the check restored the field in a new wave */
+		}
+
+		/* no target inside the search window: if the wave was stopped by the window, *
+		 * double the margin and search again                                         */
+		if ( (expRes != 2) && windowed ) windowed = fpWindowLeak(f);
+		if ( (expRes != 2) && windowed ) {
+			margin = (margin > 0) ? 2*margin : 1;
+			if (verbose) printf("-I- Search window of wire #%u widened to margin %d\n",wireNum,margin);
+		}
+	} while ( (expRes != 2) && windowed );
 
 	/* target found, traceback */
 	if (expRes ==2) {
@@ -646,26 +2099,36 @@ int fpRouteDestination(fp  *f, unsigned int wireNum) {
 		ret=1;
 	}
 
-	/* reset floorplan */
-	for (iRow=0;iRow<rows;iRow++){
-		for (iCol=0;iCol<cols;iCol++){
-			fpSetWaveType(f,iCol,iRow,'U');
-			fpSetWaveValue(f,iCol,iRow,UINT_MAX);
-		}
-	}
+	/* reset floorplan and search window, incremental search keeps the wave for the next target */
+	if ((!incremental) || (!ret)) fpNewWave(f);
+	fpSetWindow(f,wireNum,-1);
 
 	/* print message if wave or destination mode */
-	if ( ((steppingMode=='W') || (steppingMode=='D')) && ret) {	
-		sprintf(glabel,"A target for wire #%u has been routed",wireNum);
-		waitLoop();
-		if (psEnable) postscript(drawScreen);
-	}
+	fpStep(((steppingMode=='W') || (steppingMode=='D')) && ret,"A target for wire #%u has been routed",wireNum);
 
 	return ret;
 }
 
-/* traceback wire #wireNum from target (tarX,tarY) towards source (srcX,srcY) *
- * trace modes:- 'T': minimum turns, 'C': minimum contour                     */
+/* check if cell (iCol,iRow) is in the routed tree of wire #wireNum (source, wire or routed target) *
+ * with wave value waveValue; tiles traced back by the current traceback are in the tree as well    */
+static inline int fpIsTree(fp  *f, unsigned int iCol, unsigned int iRow, unsigned int wireNum, unsigned int waveValue) {
+	char cellType = fpGetCellType(f,iCol,iRow);
+	return ( (cellType == 'S') || (cellType == 's') || (cellType == 'w') || (cellType == 't') ) &&
+	       (fpGetCellValue(f,iCol,iRow) == wireNum) && (fpGetWaveValue(f,iCol,iRow) == waveValue);
+}
+
+/* check if a neighbor of tile (iCol,iRow) is in the routed tree of wire #wireNum with wave value waveValue */
+static inline int fpTouchTree(fp  *f, unsigned int iCol, unsigned int iRow, unsigned int wireNum, unsigned int waveValue) {
+	return ( (iCol < f->col-1) && fpIsTree(f,iCol+1,iRow,wireNum,waveValue) ) ||
+	       ( (iCol > 0       ) && fpIsTree(f,iCol-1,iRow,wireNum,waveValue) ) ||
+	       ( (iRow < f->row-1) && fpIsTree(f,iCol,iRow+1,wireNum,waveValue) ) ||
+	       ( (iRow > 0       ) && fpIsTree(f,iCol,iRow-1,wireNum,waveValue) );
+}
+
+/* traceback wire #wireNum from target (tarX,tarY) towards source (srcX,srcY)   *
+ * trace modes:- 'T': minimum turns, 'C': minimum contour                       *
+ * residue labels (mod 3) are followed until the next step would be to the tree *
+ * (wave value 0), the tile traced before has the label of one step back        */
 void fpTraceback(fp  *f, unsigned int tarX, unsigned int tarY,
                          unsigned int srcX, unsigned int srcY,
                          unsigned int wireNum, char traceMode) {
@@ -678,12 +2141,14 @@ void fpTraceback(fp  *f, unsigned int tarX, unsigned int tarY,
 	unsigned int valDown=UINT_MAX;
 	unsigned int valRight=UINT_MAX;
 	unsigned int valLeft=UINT_MAX;
-	unsigned int waveCnt=fpGetWaveValue(f,curX,curY);
+	unsigned int waveCnt=fpGetWaveValue(f,tarX,tarY)-1; /* traceback from target, first step to one wave before */
 	char *traceOrder="RDLU";	/* R:Right, D:Down, L:Left, U:Up */
 	char prvDir='R';			/* previous direction */
+	int mod=(f->waveMod != NULL);	/* residue labels */
 	int i;
 
-	for (waveCnt=fpGetWaveValue(f,tarX,tarY);waveCnt>0;waveCnt--) { /* traceback from target */
+	if (mod) waveCnt = (fpGetWaveValue(f,tarX,tarY)+2)%3;
+	while ( mod ? (!fpTouchTree(f,curX,curY,wireNum,waveCnt)) : (waveCnt > 0) ) {
 
 		/* get neighbors' expansion values */
 		valUp=UINT_MAX;
@@ -740,183 +2205,270 @@ void fpTraceback(fp  *f, unsigned int tarX, unsigned int tarY,
 		if (fpGetCellType(f,curX,curY)=='E') {	    /* if empty, mark as wire */
 			fpSetCellType(f,curX,curY,'w');
 			fpSetCellValue(f,curX,curY,wireNum);
-			if (steppingMode=='W') {					/* print message */
-				sprintf(glabel,"Trace back from target #%u",wireNum);
-				waitLoop();
-				if (psEnable) postscript(drawScreen);
-			}
+			fpAddTree(f,curX,curY,wireNum);
+			fpStep(steppingMode=='W',"Trace back from target #%u",wireNum);	/* print message */
 		}
 
+		waveCnt = mod ? (waveCnt+2)%3 : waveCnt-1;
 	}
 	fpSetCellType(f,tarX,tarY,'t'); /* mark as routed target */
+	fpAddTree(f,tarX,tarY,wireNum);
 
 }
 /* route wire wireNum to all destinations *
  * returns 1 if routeable, 0 other wise   */
 int fpRouteWire(fp  *f, unsigned int wireNum) {
-	unsigned int iRow, iCol, rows=f->row, cols=f->col;
+	unsigned int cols=f->col;
 	unsigned int dstNum=f->dstNum[wireNum];
-	unsigned int i=0;
+	gridInd ind, i=0;
+	arenaReset(f->arena);								/* scratch memory of the last wire   */
+	f->treeWire = UINT_MAX;								/* start routed tree from the source */
+	f->incWire  = UINT_MAX;								/* and a new distance field          */
+	fpAddTree(f,f->srcX[wireNum],f->srcY[wireNum],wireNum);
 	for (i=0;i<dstNum;i++) { 						/* route all destinations */
 		if (fpRouteDestination(f,wireNum) == 0) {	/* if failed, ripup and sned message */
 			fpRipupWire(f,wireNum);
-			if ((steppingMode=='W') || (steppingMode=='D') || (steppingMode=='N')) {				
-				sprintf(glabel,"Wire #%u is not routable!",wireNum);
-				waitLoop();
-				if (psEnable) postscript(drawScreen);
-			}
+			fpStep((steppingMode=='W') || (steppingMode=='D') || (steppingMode=='N'),"Wire #%u is not routable!",wireNum);
 			return 0;
 		}
 	}
 	fpSetCellType(f,f->srcX[wireNum],f->srcY[wireNum],'s'); /* mark as routed source */
 
 	/* mark partially routed wires as fully routed */
-	for (iRow=0;iRow<rows;iRow++){
-		for (iCol=0;iCol<cols;iCol++){
-			if (fpGetCellType(f,iCol,iRow)=='w') {fpSetCellType(f,iCol,iRow,'W');}
+	for (i=0;i<f->treeNum;i++) {
+		ind=f->treeCell[i];
+		if (fpGetCellType(f,ind%cols,ind/cols)=='w') {fpSetCellType(f,ind%cols,ind/cols,'W');}
+	}
+	f->treeWire = UINT_MAX; /* tree is complete */
+	fpStep((steppingMode=='W') || (steppingMode=='D') || (steppingMode=='N'),"Wire #%u has been routed successfully!",wireNum); /* message */
+	return 1;
+}
+
+/* refresh the empty tiles bitboard inside the routing region from the grid, *
+ * other views may have routed there since the bitboard was last updated    */
+static void fpSyncBB(fp  *f) {
+	unsigned int iRow, iCol;
+	for (iRow=f->regY0;iRow<=f->regY1;iRow++) {
+		for (iCol=f->regX0;iCol<=f->regX1;iCol++) {
+			if (fpGetCellType(f,iCol,iRow) == 'E') bbSet(f->bbPass,iCol,iRow);
+			else                                   bbClr(f->bbPass,iCol,iRow);
 		}
 	}
-	if ((steppingMode=='W') || (steppingMode=='D') || (steppingMode=='N')) { /* message */
-		sprintf(glabel,"Wire #%u has been routed successfully!",wireNum);
-		waitLoop();
-		if (psEnable) postscript(drawScreen);
+}
+
+/* route wire #wireNum inside region columns x0 to x1 and rows y0 to y1, which holds its pins:   *
+ * searches, tracebacks and the ripup of a failed wire stay inside it. views of a floorplan may *
+ * route wires concurrently if their regions widened by one tile do not overlap                *
+ * returns 1 if routeable, 0 other wise                                                         */
+int fpRouteWireRegion(fp  *f, unsigned int wireNum, unsigned int x0, unsigned int x1,
+                                                    unsigned int y0, unsigned int y1) {
+	int ret;
+	f->regX0 = x0; f->regX1 = x1;
+	f->regY0 = y0; f->regY1 = y1;
+	if (f->bbPass != NULL) fpSyncBB(f);
+	ret = fpRouteWire(f,wireNum);
+	f->regX0 = 0; f->regX1 = f->col-1;	/* back to the whole grid */
+	f->regY0 = 0; f->regY1 = f->row-1;
+	fpSetWindow(f,wireNum,-1);
+	return ret;
+}
+
+/* ripup tile (iCol,iRow) if it belongs to wire #wireNum, returns 1 if it's the routed source */
+static inline int fpRipupCell(fp  *f, unsigned int iCol, unsigned int iRow, unsigned int wireNum) {
+	char cellType=fpGetCellType(f,iCol,iRow);
+	unsigned int val=fpGetCellValue(f,iCol,iRow);
+	if ( (toupper(cellType) == 'W') && (val == wireNum) ) { /* if wire, make empty */
+		fpSetCellType(f,iCol,iRow,'E');
+		fpSetCellValue(f,iCol,iRow,UINT_MAX);
+	} else if ( (cellType == 's') && (val == wireNum) ) { /* if routed source, make unrouted */
+		fpSetCellType(f,iCol,iRow,'S');
+		return 1;
+	} else if ( (cellType == 't') && (val == wireNum) ) { /* if routed target, make unrouted */
+		fpSetCellType(f,iCol,iRow,'T');
 	}
-	return 1;
+	return 0;
 }
 
-/* ripup wire #wireNum */
+/* ripup wire #wireNum, only the routed tree cells are visited if the tree of the wire is tracked *
+ * otherwise the routing region is scanned (the wire tiles are inside it)                        */
 void fpRipupWire(fp  *f, unsigned int wireNum) {
-	unsigned int iRow, iCol, rows=f->row, cols=f->col;
-	unsigned int val;
-	char cellType;
+	unsigned int iRow, iCol, cols=f->col, run;
+	gridInd i;
 	int fullyRouted=0;
-	for (iRow=0;iRow<rows;iRow++){
-		for (iCol=0;iCol<cols;iCol++){
-			cellType=fpGetCellType(f,iCol,iRow);
-			val=fpGetCellValue(f,iCol,iRow);
-			if ( (toupper(cellType) == 'W') && (val == wireNum) ) { /* if wire, make empty */
-				fpSetCellType(f,iCol,iRow,'E');
-				fpSetCellValue(f,iCol,iRow,UINT_MAX);
-			} else if ( (cellType == 's') && (val == wireNum) ) { /* if routed source, make unrouted */
-				fpSetCellType(f,iCol,iRow,'S');
-				fullyRouted=1;
-			} else if ( (cellType == 't') && (val == wireNum) ) { /* if routed target, make unrouted */
-				fpSetCellType(f,iCol,iRow,'T');
+	if (f->treeWire == wireNum) {	/* routed tree holds all tiles of the wire */
+		for (i=0;i<f->treeNum;i++) fullyRouted |= fpRipupCell(f,f->treeCell[i]%cols,f->treeCell[i]/cols,wireNum);
+	} else {
+		for (iRow=f->regY0;iRow<=f->regY1;iRow++){
+			for (iCol=f->regX0;iCol<=f->regX1;iCol++) {
+				if ((run = fpEmptyRun(f,iCol,iRow)) > 0) iCol += run-1;	/* empty */
+				else fullyRouted |= fpRipupCell(f,iCol,iRow,wireNum);
 			}
-			fpSetWaveType(f,iCol,iRow,'U');			/* mark unvisited */
-			fpSetWaveValue(f,iCol,iRow,UINT_MAX);
 		}
 	}
-	if ( ((steppingMode=='W') || (steppingMode=='D') || (steppingMode=='N')) && fullyRouted) {
-		sprintf(glabel,"Wire #%u has been ripped-up!",wireNum);
-		waitLoop();
-		if (psEnable) postscript(drawScreen);
+	fpNewWave(f);							/* mark unvisited */
+	if (f->treeWire == wireNum) f->treeWire = UINT_MAX;	/* routed tree is gone */
+	fpStep(((steppingMode=='W') || (steppingMode=='D') || (steppingMode=='N')) && fullyRouted,"Wire #%u has been ripped-up!",wireNum);
+}
+
+/* route wire #wireNum, if unrouteable ripup the wire that blocks it most and route both again. *
+ * returns the change of the amount of routed wires (the ripped-up wire was routed)            */
+static int fpRouteRipup(fp  *f, unsigned int wireNum) {
+	unsigned int ripup;
+	int routed=0;
+	if (fpRouteWire(f,wireNum)) {						/* if routed */
+		if (verbose) {printf("-I- Wire# %u routed successfully\n",wireNum);}
+		return 1;
+	}
+	if (verbose) {printf("-I- failed to route wire# %u\n",wireNum);}	/* unrouteable */
+	ripup=fpFindBlockingWire(f,wireNum);				/* choose wire to ripup */
+	fpRipupWire(f,ripup); routed--;						/* ripup */
+	if (verbose) {printf("-I- ripup wire# %u\n",ripup);}
+	if (fpRouteWire(f,wireNum)) {						/* reroute */
+		routed++;
+		if (verbose) {printf("-I- Wire# %u routed successfully\n",wireNum);}
 	}
+	if (fpRouteWire(f,ripup)) {							/* reroute ripped-up */
+		routed++;
+		if (verbose) {printf("-I- Wire# %u routed successfully\n",ripup);}
+	}
+	return routed;
 }
 
-/* route all wires in floorplan, returns the amount of successfully routed wires*/
+/* route all wires in floorplan, returns the amount of successfully routed wires. a search window *
+ * (-margin) gives other paths than the whole region, hence wires left unrouted by their windows  *
+ * are routed again (with ripup) in the whole region, one by one; routed wires are kept           */
 int fpRouteAll(fp  *f) {
-	unsigned int i,ripup,routed=0;
+	unsigned int i,w,routed=0;
+	int margin=winMargin;
+	size_t high;
 	fpOrderWireByBBox(f);
-	for(i=0;i<(f->wireNum);i++) {					/* route all wires */
-		if (fpRouteWire(f,(f->routeOrder[i]))) {	/* by order */
-			routed ++;								/* if routed */
-			if (verbose) {printf("-I- Wire# %u routed successfully\n",f->routeOrder[i]);}
-		}
-		else { /* unrouteable */
-			if (verbose) {printf("-I- failed to route wire# %u\n",f->routeOrder[i]);}
-			ripup=fpFindBlockingWire(f,f->routeOrder[i]);			/* choose wire to ripup */
-			fpRipupWire(f,ripup); routed--;							/* ripup */
-			if (verbose) {printf("-I- ripup wire# %u\n",ripup);}
-			if (fpRouteWire(f,(f->routeOrder[i]))) {				/* reroute */
-				routed++;
-				if (verbose) {printf("-I- Wire# %u routed successfully\n",f->routeOrder[i]);}
-			}
-			if (fpRouteWire(f,ripup)) {								/* reroute ripped-up */
-				routed++;
-				if (verbose) {printf("-I- Wire# %u routed successfully\n",ripup);}
-			}
+	if ((jobs > 1) && (searchMode != 'P')) {	/* threads route first, their wires are moved to the front */
+		if (lookahead > 0) routed = parRouteSpeculative(f,jobs,lookahead);	/* speculative      */
+		else               routed = parRouteDisjoint(f,jobs);				/* disjoint batches */
+		if (f->bbPass != NULL) fpSyncBB(f);
+	}
+	for(i=routed;i<(f->wireNum);i++) routed += fpRouteRipup(f,f->routeOrder[i]);	/* route all (other) wires by order */
+	if ((margin >= 0) && (routed < f->wireNum)) {	/* unrouted wires: source is not marked as routed */
+		if (verbose) {printf("-I- %u wires left unrouted in search windows, routing them in the whole region\n",f->wireNum-routed);}
+		winMargin = -1;
+		for(i=0;i<(f->wireNum);i++) {
+			w = f->routeOrder[i];
+			if (fpGetCellType(f,f->srcX[w],f->srcY[w]) != 's') routed += fpRouteRipup(f,w);
 		}
+		winMargin = margin;
 	}
 
-	sprintf(glabel,"Routing finished! %u out of %u wires have been routed successfully!",routed,f->wireNum);
-	waitLoop();
-	if (psEnable) postscript(drawScreen);
+	if (verbose) {printf("-I- %llu tiles expanded by wave searches\n",f->visitCnt);}
+	for (i=0,high=MAX(f->arenaHigh,f->arena->high);i<f->probeNum;i++) high = MAX(high,f->probeView[i]->arena->high);
+	if (verbose) {printf("-I- arena scratch memory high-water mark: %zu bytes per routing thread\n",high);}
+	if (verbose && frontierAlpha) {printf("-I- %llu wave steps top-down, %llu bottom-up\n",f->tdSteps,f->buSteps);}
+	fpStep(1,"Routing finished! %u out of %u wires have been routed successfully!",routed,f->wireNum);
 
 	return routed;
 }
 
-/* order floorplan wires by their bbox area, f->routerOrder holds the ordered indexes */
+/* half perimeter of the bounding box of wire #iWire pins */
+static unsigned int fpWireHalfPerimeter(fp  *f, unsigned int iWire) {
+	unsigned int minX=f->srcX[iWire], maxX=f->srcX[iWire];
+	unsigned int minY=f->srcY[iWire], maxY=f->srcY[iWire];
+	unsigned int i;
+	for (i=0;i<(f->dstNum[iWire]);i++) {
+		if ((f->dstX[iWire][i])<minX) minX=f->dstX[iWire][i];
+		if ((f->dstX[iWire][i])>maxX) maxX=f->dstX[iWire][i];
+		if ((f->dstY[iWire][i])<minY) minY=f->dstY[iWire][i];
+		if ((f->dstY[iWire][i])>maxY) maxY=f->dstY[iWire][i];
+	}
+	return (maxX-minX)+(maxY-minY);
+}
+
+/* wire ordering keys, wires are routed in ascending key order (64-bit: areas of wide grids) */
+static unsigned long long fpKeyArea     (fp *f, unsigned int iWire) {return f->bbox[iWire];}		/* small nets first */
+static unsigned long long fpKeyPerimeter(fp *f, unsigned int iWire) {return fpWireHalfPerimeter(f,iWire);}
+static unsigned long long fpKeyPins     (fp *f, unsigned int iWire) {return f->dstNum[iWire]+1;}	/* few pins first   */
+/* infiles carry no timing, longest (half perimeter) wires are taken as most critical and routed first */
+static unsigned long long fpKeyCriticality(fp *f, unsigned int iWire) {return UINT_MAX-fpWireHalfPerimeter(f,iWire);}
+
+/* order floorplan wires by the key chosen by orderMode (bbox area by default), *
+ *  f->routerOrder holds the ordered indexes, equal keys keep wire index order   */
 void fpOrderWireByBBox(fp  *f) {
 	unsigned int  wnum=f->wireNum;
-	unsigned int *bbox=f->bbox;
-	unsigned int *rord=f->routeOrder;
-	unsigned int minind;
-	unsigned int i,j;
-
-	/* make a copy of bbox array */
-	unsigned int *bboxc = (unsigned int*)malloc(sizeof(unsigned int)*wnum);
-	for (i=0;i<wnum;i++) {bboxc[i]=bbox[i];}
+	unsigned long long *key;
+	unsigned int *tmp;
+	unsigned long long (*keyFunc)(fp*,unsigned int);
+	unsigned int i;
 
-	/* sort */
-	for (i=0;i<wnum;i++) {
-		minind=minInd(bboxc,wnum);
-		bboxc[minind]=UINT_MAX;
-		rord[i]=minind;
+	switch (orderMode) {
+		case 'H': keyFunc=fpKeyPerimeter;   break;
+		case 'P': keyFunc=fpKeyPins;        break;
+		case 'C': keyFunc=fpKeyCriticality; break;
+		default : keyFunc=fpKeyArea;
 	}
-	if (bbox != NULL) {free(bboxc);}
+
+	/* compute keys and sort, temporary arrays are taken from the arena */
+	arenaReset(f->arena);
+	key = (unsigned long long*)arenaAlloc(f->arena,sizeof(unsigned long long)*wnum);
+	tmp = (unsigned int*)arenaAlloc(f->arena,sizeof(unsigned int)*wnum);
+	for (i=0;i<wnum;i++) key[i]=keyFunc(f,i);
+	sortInd(key,f->routeOrder,tmp,wnum);
+	arenaReset(f->arena);
 }
 
-/* for each wire, count how many it tackles a wave expansion form (expX,expY) *
- *  results for each wire are located in f->ripCnt                            */
-void fpCountBlockage(fp  *f, unsigned int expX, unsigned int expY) {
+/* count into cnt (zero on entry) how many times each wire tackles a wave expansion from (expX,expY), *
+ * the wires that tackle it are listed in hit (unless NULL). returns the number of these wires       */
+unsigned int fpCountBlockers(fp  *f, unsigned int expX, unsigned int expY, unsigned int *cnt, unsigned int *hit) {
 	unsigned int  wnum=f->wireNum;
 	unsigned int i, j, iRow, iCol, rows=f->row, cols=f->col;
 	unsigned int curX, curY;
-	unsigned int val;
-	int expandable=1;
+	unsigned int val, cell, tag;
+	gridInd head=0, at;				/* forehead queue head */
+	unsigned int hitNum=0;
 	int add[]={-1,0,+1};			/* direction */
-	char cellType,waveType;
-	fpSetWaveType(f,expX,expY,'F');
+	fpNewWave(f);
+	fpAddFront(f,expX,expY);
+
+	/* expand from point to check blocking wires, curFront is used as a queue */
+	while (head < f->curFrontNum) {
+		iCol=f->curFront[head]%cols;
+		iRow=f->curFront[head]/cols;
+		head++;
+		for (i=0;i<3;i++) {
+			for (j=0;j<3;j++) {		/* for all directions */
+				if ( (i==0) && (j==0) ) continue;	/* but not the same point */
+				curX=iCol+add[i];
+				curY=iRow+add[j];
+				if ( (curX<0) || (curX>=cols) || (curY<0) || (curY>=rows) ) continue; /* avoid boundary	*/
+				at   = fpAt(f,curX,curY);	/* cell and wave tag are read once */
+				cell = FP_MAP(f->cell,at);
+				tag  = fpWaveTagAt(f,at);
+				val  = FP_CELL_VALUE(cell);
+				if ( FP_CELL_EMPTY(cell) && (FP_WAVE_TYPE(tag) == 'U') ) {
+					fpAddFront(f,curX,curY); /* expand */
+				} else if ((FP_CELL_TYPE(cell)=='W') && (val!=wnum)) {	/* other wire blocks expansion*/
+					if ((cnt[val]++) == 0) {					/* first time */
+						if (hit != NULL) hit[hitNum] = val;
+						hitNum++;
+					}
+				}
+			} /* for j */
+		} /* for i */
+		fpSetWaveType(f,iCol,iRow,'V');
+	} /* while forehead */
 
-	/* reset ripCnt */
-	for (i=0;i<wnum;i++) (f->ripCnt[i])=0;
+	/* reset state */
+	fpNewWave(f);
+	return hitNum;
+}
 
-	/* expand from point to check blocking wires */
-	while (expandable) {
-		expandable=0;
-		for (iRow=0;iRow<rows;iRow++){
-			for (iCol=0;iCol<cols;iCol++){
-
-				if (fpGetWaveType(f,iCol,iRow)=='F') {
-					expandable=1;
-					for (i=0;i<3;i++) {
-						for (j=0;j<3;j++) {		/* for all directions */
-							if ( (i==0) && (j==0) ) continue;	/* but not the same point */
-							curX=iCol+add[i];
-							curY=iRow+add[j];
-							if ( (curX<0) || (curX>=cols) || (curY<0) || (curY>=rows) ) continue; /* avoid boundary	*/
-							cellType = fpGetCellType(f,curX,curY);
-							val = fpGetCellValue(f,curX,curY);
-							waveType = fpGetWaveType(f,curX,curY);						
-							if ( (cellType == 'E') && (waveType == 'U') ) {
-								fpSetWaveType(f,curX,curY,'F'); /* expand */
-							} else if ((cellType=='W') && (val!=wnum)) (f->ripCnt[val])++;	/* other wire blocks expansion*/								
-						} /* for j */
-					} /* for i */
-				fpSetWaveType(f,iCol,iRow,'V');
-				}	/* if 'F' */
-			}	/* for iCol */
-		}	/* for iRow*/
-	} /* while expandable */
+/* for each wire, count how many it tackles a wave expansion form (expX,expY) *
+ *  results for each wire are located in f->ripCnt                            */
+void fpCountBlockage(fp  *f, unsigned int expX, unsigned int expY) {
+	unsigned int  wnum=f->wireNum;
+	unsigned int i;
 
-	/* reset state */
-	for (iRow=0;iRow<rows;iRow++){
-		for (iCol=0;iCol<cols;iCol++){
-			fpSetWaveType(f,iCol,iRow,'U');
-		}
-	}
+	/* reset ripCnt */
+	for (i=0;i<wnum;i++) (f->ripCnt[i])=0;
 
+	fpCountBlockers(f,expX,expY,f->ripCnt,NULL);
 }
 
 /* find the maximum blocking wire to wire #wireNum                          *
@@ -927,10 +2479,12 @@ unsigned int fpFindBlockingWire(fp  *f, unsigned int wireNum) {
 	unsigned int  wnum=f->wireNum;
 	unsigned int iRow, iCol, rows=f->row, cols=f->col;
 	unsigned int blockingWire;
-	unsigned int val,i;
+	unsigned int val,i,run;
 	char cellType;
+	if (jobs > 1) return parFindBlockingWire(f,wireNum,jobs);	/* probes by threads, same result */
 	for (iRow=0;iRow<rows;iRow++){
 		for (iCol=0;iCol<cols;iCol++){
+			if ((run = fpEmptyRun(f,iCol,iRow)) > 0) {iCol += run-1; continue;}	/* empty */
 			cellType = fpGetCellType(f,iCol,iRow);
 			val = fpGetCellValue(f,iCol,iRow);
 			if ( (cellType == 'S') && (val == wireNum) ||		/* if relevant unrouted source			*/
@@ -947,3 +2501,27 @@ unsigned int fpFindBlockingWire(fp  *f, unsigned int wireNum) {
 	initArr(f->ripCnt,0,wnum);				/* init for next turn	*/
 	return blockingWire;
 }
+
+/* benchmark the grid layout (FP_LAYOUT): a Lee-Moore wave (fpWaveExpand) floods an empty    *
+ * size X size grid from its center, the expanded tiles and the run time are printed (-grid) */
+void fpWaveBench(unsigned int size) {
+	fp *f = fpCreateGrid(size,size);
+	unsigned int tarX, tarY, steps=0;
+	clock_t start;
+#if   FP_LAYOUT == FP_LAYOUT_TILE
+	const char *layout = "tiled";
+#elif FP_LAYOUT == FP_LAYOUT_MORTON
+	const char *layout = "Z-order";
+#else
+	const char *layout = "row-major";
+#endif
+	fpCreateWires(f,1);	/* wire #0 without targets */
+	start = clock();
+	fpNewWave(f);
+	fpAddFront(f,size/2,size/2);
+	fpSetWaveValue(f,size/2,size/2,0);
+	while (fpWaveExpand(f,0,&tarX,&tarY)) steps++;	/* no targets, flood the whole grid */
+	printf("-I- %s %ux%u grid: %llu tiles expanded by %u wave steps in %.3f seconds\n",
+	       layout,size,size,f->visitCnt,steps,(double)(clock()-start)/CLOCKS_PER_SEC);
+	fpDelete(f);
+}
@@ -34,39 +34,277 @@
 #ifndef __FLOORPLAN_HEADER__
 #define __FLOORPLAN_HEADER__
 
+#include "common.h" /* gridInd */
+
+struct bbStr; /* bitboard, see bitboard.h */
+struct parWaveStr; /* wave search threads, see parallel.c */
+
+/* packed grid cell word (fp cell): cell type code in the top bits, cell value (wire number) below, *
+ * complemented so that an empty cell without value is an all-zero word: blocks of the tile map     *
+ * (FP_BLOCK) are empty as allocated, untouched and empty parts of a floorplan are never allocated */
+#define FP_TYPE_SHIFT 28                          /* cell type code bits start here                 */
+#define FP_VALUE_MASK ((1u<<FP_TYPE_SHIFT)-1)     /* cell value field, all ones stands for UINT_MAX */
+#define FP_CELL_TYPES "EBWSTstw"                  /* cell type of each code                         */
+#define FP_CELL_E     0                           /* code of empty cells                            */
+#define FP_CELL_T     4                           /* code of unrouted targets                       */
+#define FP_CELL(code,value) (((unsigned int)(code)<<FP_TYPE_SHIFT)|((~(value))&FP_VALUE_MASK))
+#define FP_CELL_TYPE(cell)  (FP_CELL_TYPES[(cell)>>FP_TYPE_SHIFT])
+#define FP_CELL_VALUE(cell) ((((cell)&FP_VALUE_MASK)==0) ? UINT_MAX : ((~(cell))&FP_VALUE_MASK))
+#define FP_CELL_EMPTY(cell) (((cell)>>FP_TYPE_SHIFT)==FP_CELL_E)
+
+/* wave tag byte (fp waveTag): wave type code and a touched bit, set once the current search wrote  *
+ * the tile. each block of tags carries the id of the search that cleared it last (waveBlk), hence  *
+ * tags of blocks cleared by another search are untouched (FP_WAVE_NEW), i.e. unvisited            */
+#define FP_WAVE_BITS  3                           /* wave type code bits                            */
+#define FP_WAVE_TYPES "UVFfRr"                    /* wave type of each code                         */
+#define FP_WAVE_U     0                           /* code of unvisited tiles                        */
+#define FP_WAVE_V     1                           /* code of visited tiles                          */
+#define FP_WAVE_F     2                           /* code of forehead tiles                         */
+#define FP_WAVE_NEW   0                           /* tag of untouched tiles, no wave value          */
+#define FP_EPOCH_END  UINT_MAX                    /* wave search ids wrap around here               */
+#define FP_EPOCH_BUSY FP_EPOCH_END                /* waveBlk of a block being cleared by a thread   */
+#define FP_WAVE_TAG(code)       ((1u<<FP_WAVE_BITS)|(code))
+#define FP_WAVE_TYPE(tag)       (FP_WAVE_TYPES[(tag)&((1u<<FP_WAVE_BITS)-1)])
+#define FP_FRONT_MIN  1024                        /* initial size of the forehead buffers           */
+
+/* residue wave labels (-residue): wave value mod 3 in 2 bits, 16 tiles per word of waveMod.     *
+ * neighbors of a visited tile differ by one level at most, hence the label finds the predecessor */
+#define FP_MOD_NONE       3                         /* no wave value (UINT_MAX)                       */
+#define FP_MOD_LABEL(val) (((val) == UINT_MAX) ? FP_MOD_NONE : (val)%3)
+#define FP_MOD_WORD(at)   (FP_BLOCK_OFF(at)>>4)     /* word of the waveMod block of storage index at  */
+#define FP_MOD_SHIFT(at)  (((at)&15)<<1)            /* bit position of storage index at in its word   */
+
+/* grid storage layout, chosen at compile time (-DFP_LAYOUT=FP_LAYOUT_TILE): cell, waveValue and *
+ * waveTag of tile (iCol,iRow) are stored at fpAt(f,iCol,iRow). grid indices (iRow*col+iCol) of *
+ * foreheads, trees and queues stay row-major, hence search order does not depend on the layout  */
+#define FP_LAYOUT_ROW    0  /* row by row                                                       */
+#define FP_LAYOUT_TILE   1  /* 64x64 tiles, row by row inside a tile and tile by tile           */
+#define FP_LAYOUT_MORTON 2  /* Z-order: column and row bits interleaved                        */
+#ifndef FP_LAYOUT
+#define FP_LAYOUT FP_LAYOUT_ROW
+#endif
+#define FP_TILE_BITS     6  /* tile side is 2^FP_TILE_BITS                                      */
+
+/* tile map: grid arrays (cell, waveTag, waveValue, waveMod) are directories of blocks of       *
+ * FP_BLOCK_SIZE storage indices each (a 64x64 tile in the tile layout). blocks never written   *
+ * point to fpZeroBlock, one shared read-only block of zeros (empty cells, unvisited tags); the *
+ * first write of a block allocates it (FP_MAP_W), hence memory follows the blocks that hold    *
+ * blockages, pins and wires or were reached by wave searches, not the grid size                */
+#define FP_BLOCK_BITS    (2*FP_TILE_BITS)          /* a block holds 2^FP_BLOCK_BITS storage indices */
+#define FP_BLOCK_SIZE    (1u<<FP_BLOCK_BITS)
+#define FP_BLOCK(at)     ((at)>>FP_BLOCK_BITS)     /* block of storage index at                     */
+#define FP_BLOCK_OFF(at) ((at)&(FP_BLOCK_SIZE-1))  /* place of storage index at in its block        */
+#define FP_MOD_BLOCK     (FP_BLOCK_SIZE/16)        /* words of a waveMod block                      */
+#define FP_TAG_BLOCK     (FP_BLOCK_SIZE/4)         /* words of a waveTag block, a byte per index    */
+#define FP_MAP(dir,at)   ((dir)[FP_BLOCK(at)][FP_BLOCK_OFF(at)])                       /* read    */
+#define FP_MAP_W(dir,at) (fpBlockW((dir),FP_BLOCK(at),FP_BLOCK_SIZE)+FP_BLOCK_OFF(at)) /* write   */
+extern const unsigned int fpZeroBlock[FP_BLOCK_SIZE];
+unsigned int *fpBlockAlloc(unsigned int **entry, size_t words);
+
 /* floorplan structure */
 struct fpStr	{
 	
 	/* floorplan Grid */
 	unsigned int  col;	     /* number of columns in the floorplan (X dimension)                         */
 	unsigned int  row;	     /* number of rows in the floorplan (Y dimension)                            */
-	unsigned int *cellValue; /* a value assigned to floorplan tiles                                      */
-	unsigned int *waveValue; /* a wave expansion value assigned to floorplan tiles                       */
-	char	     *cellType;  /* Grid cell type:-      E:Empty, B:Blockage, W:Wire, S:Source,             */ 
+	gridInd       store;     /* number of stored tiles, col*row plus padding of the layout (fpAt)      */
+	gridInd       blockNum;  /* number of blocks in each tile map directory (FP_BLOCK)                 */
+	unsigned int  layoutArg; /* tile layout: tiles in a row of tiles, Z-order: interleaved bits        */
+	int           view;      /* view of another floorplan (fpCreateView), 0: no, 1: grid cells and wires */
+	                         /* are shared, 2: wires are shared and grid cells are a private copy      */
+	                         /* (ripup counters ripCnt and ripCntAcc of views are private)            */
+	unsigned int **cell;     /* packed grid cell (FP_CELL): a value assigned to floorplan tiles and      */
+	                         /* Grid cell type:-      E:Empty, B:Blockage, W:Wire, S:Source,             */
 	                         /*                       T:Target s:routed source t:routed target           */
-	char	     *waveType;	 /* Expansion wave type:- U:Unvisited, V:Visited,                            */
+	unsigned int **waveValue; /* a wave expansion value assigned to floorplan tiles, touched by searches */
+	unsigned int **waveMod;  /* residue wave labels (FP_MOD_LABEL) replacing waveValue, NULL: not used   */
+	unsigned int **waveTag;  /* wave tag bytes (FP_WAVE_TAG) of the tiles: touched by the current search */
+	                         /* and Expansion wave type:- U:Unvisited, V:Visited,                        */
                              /*                       F:Forehead, f:new forehead                         */
+                             /*                       R:backward forehead, r:backward visited (two-way)  */
+	unsigned int *waveBlk;   /* id of the wave search (waveEpoch) that cleared each waveTag block        */
+	gridInd      *curFront;  /* grid indices (iRow*col+iCol) of the current wave forehead cells          */
+	gridInd      *nxtFront;  /* grid indices of the new forehead cells, found by the current expansion   */
+	gridInd       curFrontNum; /* number of cells in curFront                                            */
+	gridInd       nxtFrontNum; /* number of cells in nxtFront                                            */
+	gridInd       curFrontCap; /* allocated size of curFront, forehead buffers grow on use (fpGrowFront) */
+	gridInd       nxtFrontCap; /* allocated size of nxtFront                                             */
+	unsigned int  waveEpoch; /* id of the current wave search, tag blocks of other ids are unvisited    */
+	gridInd      *treeCell;  /* grid indices of the routed tree (source, wires, targets) of treeWire    */
+	gridInd       treeNum;   /* number of cells in treeCell                                            */
+	gridInd       treeCap;   /* allocated size of treeCell                                             */
+	unsigned int  treeWire;  /* wire number treeCell belongs to, UINT_MAX if none                      */
+	gridInd      *bkFront;   /* backward wave forehead of two-way search, allocated on first use       */
+	gridInd      *bkNext;    /* new backward wave forehead cells                                       */
+	gridInd       bkFrontNum; /* number of cells in bkFront                                            */
+	gridInd       bkNextNum;  /* number of cells in bkNext                                             */
+	gridInd       bkFrontCap; /* allocated size of bkFront                                             */
+	gridInd       bkNextCap;  /* allocated size of bkNext                                              */
+	unsigned long long visitCnt; /* number of tiles expanded by all wave searches (statistics)         */
+	unsigned int  winX0;     /* search window: wave searches expand only inside columns winX0 to winX1 */
+	unsigned int  winX1;     /* and rows winY0 to winY1, the whole grid unless a margin is set        */
+	unsigned int  winY0;
+	unsigned int  winY1;
+	unsigned int  regX0;     /* routing region: searches, tracebacks and ripups stay inside columns     */
+	unsigned int  regX1;     /* regX0 to regX1 and rows regY0 to regY1, the whole grid unless a wire is */
+	unsigned int  regY0;     /* routed by fpRouteWireRegion                                             */
+	unsigned int  regY1;
+
+	/* bitboard wave search (search mode 'B'), allocated on first use */
+	struct bbStr *bbPass;    /* empty tiles, kept up to date by fpSetCellType                           */
+	struct bbStr *bbFront;   /* current wave forehead                                                  */
+	struct bbStr *bbNext;    /* new wave forehead                                                      */
+	struct bbStr *bbVisit;   /* empty tiles reached by the current search                              */
+	struct bbStr *bbTarget;  /* unrouted targets of the wire being routed                              */
+	unsigned int  bbEpoch;   /* wave search id (waveEpoch) the bitboards belong to                     */
+	unsigned int  bbWire;    /* wire whose targets are set in bbTarget, UINT_MAX if none               */
+	unsigned int  bbLevel;   /* wave value of the current forehead                                     */
+	unsigned int  bbRow0;    /* first row of the forehead                                              */
+	unsigned int  bbRow1;    /* last row of the forehead, forehead is empty if bbRow0>bbRow1           */
+	unsigned int  bbVis0;    /* first row of bbVisit                                                   */
+	unsigned int  bbVis1;    /* last row of bbVisit                                                    */
+
+	/* goal-directed wave search (search modes 'A', 'H' and 'S'), allocated on first use */
+	struct bqStr *bq;        /* open tiles by key (wave value + fpHeuristic distance to go, or wave    */
+	                         /* value alone for the incremental search)                               */
+	unsigned int  bqEpoch;   /* wave search id (waveEpoch) the queue belongs to                        */
+	unsigned int  bqBase;    /* smallest key at search start, keys above it are detours                */
+	gridInd      *hTarget;   /* grid indices of the unrouted targets of the searched wire              */
+	unsigned int  hTargetNum; /* number of cells in hTarget                                            */
+	gridInd      *hSort;      /* hTarget as major*minorSize+minor, sorted: the major axis is the wider  */
+	int           hByRow;     /* side of the targets bounding box, rows if hByRow (for fpHeuristic)     */
+
+	/* incremental wave search (-incremental), distance field is kept between targets of a wire */
+	unsigned int  incWire;   /* wire the distance field belongs to, UINT_MAX if none                   */
+	unsigned int  incEpoch;  /* wave search id (waveEpoch) of the distance field                       */
+	gridInd       incTree;   /* number of cells in treeCell already seeded into the field              */
+	gridInd       incHold[4]; /* cells hidden from traceback as fpWaveExpand leaves them (forehead)    */
+	unsigned int  incHoldNum; /* number of cells in incHold                                            */
+	unsigned int  incX0;     /* search window of the distance field (winX0, winX1, winY0, winY1)       */
+	unsigned int  incX1;
+	unsigned int  incY0;
+	unsigned int  incY1;
+
+	/* frontier-parallel wave search (search mode 'P'), threads are started on first use */
+	struct parWaveStr *parWave; /* -jobs threads expanding the wave levels, NULL if not started     */
+
+	/* direction-optimizing Lee-Moore search (-frontier) */
+	unsigned int  dirEpoch;  /* wave search id (waveEpoch) the direction belongs to                    */
+	int           dirBottomUp; /* 1: levels of the current search are expanded bottom-up               */
+	gridInd       dirLabel;  /* number of tiles labelled by the current search                         */
+	unsigned int  dirVisit;  /* search id (waveEpoch) whose labelled window tiles bbVisit holds         */
+	unsigned long long tdSteps; /* number of levels expanded top-down (statistics)                     */
+	unsigned long long buSteps; /* number of levels expanded bottom-up (statistics)                    */
+
+	/* scratch memory of the thread routing in this floorplan (or view), reset between wires */
+	arena        *arena;     /* temporary arrays of searches, checks, orderings and probes             */
+	size_t        arenaHigh; /* largest arena high-water mark of the finished views (statistics)       */
 
 	/* floorplan wires*/
 	unsigned int  wireNum;	  /* number of wires                                  */
 	unsigned int *srcX;	      /* source x dimension for each source               */
 	unsigned int *srcY;	      /* source y dimension for each source               */
 	unsigned int *dstNum;	  /* number of destination for each source            */
-	unsigned int *bbox;	      /* bbox area of each net                            */
+	unsigned int **dstX;	  /* destinations x dimension for each source         */
+	unsigned int **dstY;	  /* destinations y dimension for each source         */
+	gridInd      *bbox;	      /* bbox area of each net                            */
 	unsigned int *routeOrder; /* routing order                                    */
 	unsigned int *ripCnt;     /* Counts how much a net tackles the wave expansion */
 	unsigned int *ripCntAcc;  /* Accumulative Counter                             */
+	struct fpStr **probeView; /* views for parallel blockage probes (-jobs)       */
+	unsigned int  probeNum;   /* number of views in probeView                     */
 };
 
 typedef struct fpStr fp;
 
+/* block #blk of tile map dir for writing, allocated if it is the shared zero block */
+static inline unsigned int *fpBlockW(unsigned int **dir, gridInd blk, size_t words) {
+	unsigned int *b = dir[blk];
+	return (b != fpZeroBlock) ? b : fpBlockAlloc(dir+blk,words);
+}
+
+void fpWaveReset(fp *f, gridInd blk, unsigned char *tags);
+
+/* wave tags of block #blk of floorplan f for writing by the current search: allocated if it is *
+ * the zero block, cleared if another search cleared it last (fpWaveReset)                      */
+static inline unsigned char *fpWaveBlock(fp *f, gridInd blk) {
+	unsigned char *tags = (unsigned char*)fpBlockW(f->waveTag,blk,FP_TAG_BLOCK);
+	if (__atomic_load_n(&f->waveBlk[blk],__ATOMIC_ACQUIRE) != f->waveEpoch) fpWaveReset(f,blk,tags);
+	return tags;
+}
+
+/* wave tag of storage index at in the current search, FP_WAVE_NEW if the search did not touch it */
+static inline unsigned int fpWaveTagAt(const fp *f, gridInd at) {
+	gridInd blk = FP_BLOCK(at);
+	if (__atomic_load_n(&f->waveBlk[blk],__ATOMIC_ACQUIRE) != f->waveEpoch) return FP_WAVE_NEW;
+	return ((const unsigned char*)f->waveTag[blk])[FP_BLOCK_OFF(at)];
+}
+
+/* spread the low half of the bits of v (16, or 32 if wide) to the even bits (Z-order) */
+static inline gridInd fpSpreadBits(gridInd v) {
+#ifdef WIDE_INDEX
+	v &= 0xFFFFFFFFull;
+	v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+	v = (v | (v << 8))  & 0x00FF00FF00FF00FFull;
+	v = (v | (v << 4))  & 0x0F0F0F0F0F0F0F0Full;
+	v = (v | (v << 2))  & 0x3333333333333333ull;
+	v = (v | (v << 1))  & 0x5555555555555555ull;
+#else
+	v &= 0xFFFF;
+	v = (v | (v << 8)) & 0x00FF00FF;
+	v = (v | (v << 4)) & 0x0F0F0F0F;
+	v = (v | (v << 2)) & 0x33333333;
+	v = (v | (v << 1)) & 0x55555555;
+#endif
+	return v;
+}
+
+/* storage index of tile (iCol,iRow) in the grid arrays (cell, waveValue, waveTag) of the layout */
+static inline gridInd fpAt(const fp *f, unsigned int iCol, unsigned int iRow) {
+#if   FP_LAYOUT == FP_LAYOUT_TILE
+	return ((((gridInd)(iRow >> FP_TILE_BITS)*f->layoutArg + (iCol >> FP_TILE_BITS)) << (2*FP_TILE_BITS)) |
+	        ((iRow & ((1u << FP_TILE_BITS)-1)) << FP_TILE_BITS) | (iCol & ((1u << FP_TILE_BITS)-1)));
+#elif FP_LAYOUT == FP_LAYOUT_MORTON	/* bits above the interleaved ones belong to the longer side */
+	gridInd low = ((gridInd)1 << f->layoutArg)-1;
+	return ( (gridInd)((iCol >> f->layoutArg) + (iRow >> f->layoutArg)) << (2*f->layoutArg) ) |
+	       fpSpreadBits(iCol & low) | (fpSpreadBits(iRow & low) << 1);
+#else
+	return (gridInd)iRow*f->col+iCol;
+#endif
+}
+
 extern fp *gfp;         /* global floorplan database - declaired in maze.c */
 extern int verbose;         /* verbose status            - declaired in maze.c */
 extern char steppingMode;   /* stepping mode, see maze.c - declaired in maze.c */
 extern int psEnable;
 extern char tracebackMode;
+extern char searchMode;     /* wave search engine, see maze.c - declaired in maze.c */
+extern int checkMode;       /* check wave labels against Lee-Moore expansion  */
+extern int twoWay;          /* two-way search for first target of each wire   */
+extern int winMargin;       /* search window margin around net bounding box   */
+extern int incremental;     /* keep distance field between targets of a wire  */
+extern int jobs;            /* routing threads for spatially disjoint wires   */
+extern int lookahead;       /* wires routed speculatively at once by threads  */
+extern int frontierAlpha;   /* bottom-up wave steps for foreheads over 1/alpha */
+extern int frontierBeta;    /* top-down again for foreheads under 1/beta      */
+extern int residue;         /* wave values are stored as 2-bit labels mod 3   */
+extern char orderMode;      /* wire routing order, see maze.c                 */
 extern char glabel[128]; /* global text message       - declaired in maze.c */
+extern int batchMode;       /* batch mode, no display  - declaired in maze.c */
 extern void drawScreen ();
+extern void waitLoop ();
+
+/* stepping hook: if cond holds, set global message (printf format), wait for 'Proceed' and  *
+ * plot PostScript if enabled. Compiled out in headless build, skipped at run-time in batch */
+#ifdef HEADLESS
+#define fpStep(cond,...) do { } while (0)
+#else
+#define fpStep(cond,...) do { if ( (!batchMode) && (cond) ) {                                  \
+                                  sprintf(glabel,__VA_ARGS__);                                \
+                                  waitLoop();                                                 \
+                                  if (psEnable) postscript(drawScreen);                       \
+                              } } while (0)
+#endif
 
 /* returns a new grid floorplan data structure, size colXrow */
 fp	        *fpCreateGrid (unsigned int col, unsigned int row);
@@ -74,7 +312,13 @@ fp	        *fpCreateGrid (unsigned int col, unsigned int row);
 /* creates a new wires data structure inside a floorplan structure */
 void	     fpCreateWires(fp *f, unsigned int wireNum);
 
-/* free a floorplan data structure */
+/* returns a view of floorplan f for a routing thread: wires are shared with f, grid cells too *
+ * unless copyGrid is set (then the view has a private tile map of empty cells, blocks are     *
+ * allocated as the caller copies regions of f into them). wave search state (values,          *
+ * foreheads, routed tree, queues and bitboards) is private                                    */
+fp	        *fpCreateView(fp *f, int copyGrid);
+
+/* free a floorplan data structure, or a view (fpCreateView) without the shared grid and wires */
 void	     fpDelete(fp *f);
 
 /* set floorplan grid cell value at (iCol,iRow) floorplan grid place*/
@@ -92,7 +336,7 @@ inline void	        fpSetWaveType (fp *f, unsigned int iCol, unsigned int iRow,
 /* get floorplan grid cell value from (iCol,iRow) floorplan grid place*/
 inline unsigned int fpGetCellValue(fp *f, unsigned int iCol, unsigned int iRow);
 
-/* get expansion wave value from (iCol,iRow) floorplan grid place */
+/* get expansion wave value from (iCol,iRow) floorplan grid place (mod 3 with residue labels) */
 inline unsigned int fpGetWaveValue(fp *f, unsigned int iCol, unsigned int iRow);
 
 /* get floorplan grid cell type from (iCol,iRow) floorplan grid place*/
@@ -103,10 +347,41 @@ inline char	        fpGetWaveType (fp *f, unsigned int iCol, unsigned int iRow);
 
 /* set location (srcX,srcY) and number of destinations (dstNum) and bounding box area (bbox) of wire #iWire */
 void 	            fpSetWire(fp *f, unsigned int iWire, unsigned int srcX, unsigned int srcY,
-                                                                      unsigned int dstNum, unsigned int bbox);
+                                                                      unsigned int dstNum, gridInd bbox);
 
+/* set location (dstX,dstY) of destination #iDst of wire #iWire, after fpSetWire */
+void 	            fpSetTarget(fp *f, unsigned int iWire, unsigned int iDst, unsigned int dstX, unsigned int dstY);
+
+#ifndef HEADLESS
 /* draw floorplan using EasyGl graphics module. Wold size is (xDim X yDim) */
 void	            fpDraw(fp *f, float xDim, float yDim);
+#endif
+
+/* cursor of the infile parser over the memory-mapped file, integers are scanned in place */
+struct fpScan {
+	const char   *p;        /* next character              */
+	const char   *end;      /* end of the scanned text     */
+	const char   *fileName; /* for error messages          */
+	unsigned int  lineNum;  /* line of the next character  */
+};
+
+/* report a parsing error at the current line of s and exit */
+void                fpScanError(struct fpScan *s, const char *msg);
+
+/* skip empty lines, returns 0 at the end of s */
+int                 fpScanLine(struct fpScan *s);
+
+/* scan the rest of the current line into buf (up to bufMax integers), returns the number of *
+ * integers scanned; all of them are checked even when not kept                               */
+unsigned int        fpScanRest(struct fpScan *s, unsigned int *buf, unsigned int bufMax);
+
+/* count the non-empty lines of s (returned) and its new lines (lines), s is not moved */
+unsigned int        fpScanCount(struct fpScan *s, unsigned int *lines);
+
+/* parse the lines of s into f, line is the index of the first non-empty line of s after the *
+ * number of blockages line: blockages, the number of wires (skipped) and then the wires.    *
+ * safe for threads parsing other lines of the same infile                                   */
+void                fpParseLines(fp *f, struct fpScan *s, unsigned long long line, unsigned int blockNum);
 
 /* parse floorplan infile format into a new floorplan structue, return a new allocated structure */
 fp	               *fpInfileParse(const char* filename);
@@ -115,10 +390,87 @@ fp	               *fpInfileParse(const char* filename);
 * Lee-Moore multi-destination maze routing related algorithms *
 ***************************************************************/
 
+/* start a new wave search, all tiles become unvisited in O(1) by advancing the search id */
+void                fpNewWave(fp *f);
+
+/* add cell (iCol,iRow) to the routed tree of wire #wireNum (f->treeCell), *
+ * the tree is restarted if it belongs to another wire                    */
+void                fpAddTree(fp *f, unsigned int iCol, unsigned int iRow, unsigned int wireNum);
+
+/* add cell (iCol,iRow) to the current wave forehead (f->curFront) */
+void                fpAddFront(fp *f, unsigned int iCol, unsigned int iRow);
+
+/* make room for n cells in forehead buffer *front of *cap cells, at least doubling it */
+void                fpGrowFront(gridInd **front, gridInd *cap, gridInd n);
+
+/* new forehead (f->nxtFront) becomes the current one, the old buffer is reused for the next */
+void                fpSwapFront(fp *f);
+
 /* expand wave related to wire #wireNum from targer (targetX,targetY)        *
+ * only the current wave forehead cells (f->curFront) and their neighbors   *
+ * are visited, the new forehead is left in f->curFront for the next call   *
  * returns:- 0: wave is not expandable, 1: wave is expanded, 2: target found */
 int                 fpWaveExpand(fp *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY);
 
+/* direction-optimizing fpWaveExpand (-frontier): top-down levels are expanded by fpWaveExpand, *
+ * bottom-up levels scan the unvisited empty tiles of the search window for forehead neighbors. *
+ * bottom-up when forehead*frontierAlpha exceeds the window tiles not labelled yet, top-down    *
+ * again when forehead*frontierBeta is below the window area. labels and returns as fpWaveExpand */
+int                 fpWaveExpandDir(fp *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY);
+
+/* bitboard version of fpWaveExpand: forehead, empty and visited tiles are kept as  *
+ * packed 64-tile words, one wave step is a few shift/or/and-not operations per word *
+ * wave values and types are recorded as in fpWaveExpand, hence fpTraceback works    *
+ * returns:- 0: wave is not expandable, 1: wave is expanded, 2: target found         */
+int                 fpWaveExpandBB(fp *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY);
+
+/* goal-directed (A*) version of fpWaveExpand: open tiles are kept in a bucket queue by their   *
+ * wave value plus Manhattan distance to the nearest unrouted target, one call expands all open *
+ * tiles of the smallest key. paths are still shortest and fpTraceback works on visited tiles   *
+ * returns:- 0: wave is not expandable, 1: wave is expanded, 2: target found                    */
+int                 fpWaveExpandAStar(fp *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY);
+
+/* Hadlock's minimum detour version of fpWaveExpand: a move toward the nearest unrouted target   *
+ * is free, a move away is a detour. tiles of the current detour level are kept on a stack whose *
+ * top takes the zero detour moves, hence the wave runs straight toward the target and turns    *
+ * around blockages; later levels wait in the bucket queue. one call expands one detour level.  *
+ * returns:- 0: wave is not expandable, 1: wave is expanded, 2: target found                     */
+int                 fpWaveExpandHadlock(fp *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY);
+
+/* Soukup's line probe search of wire #wireNum: from the tree tile nearest to an unrouted target, *
+ * probe depth first along straight lines toward the nearest target, keeping the direction while *
+ * it gets closer. when blocked, expand a breadth-first wave from the probe end until a tile      *
+ * closer to the target is reached, then probe again from it. visited tiles get wave values as a  *
+ * path from the tree, hence fpTraceback works, but paths are not always shortest.               *
+ * returns:- 0: probe is stuck (caller falls back to a wave search), 2: target found            */
+int                 fpWaveSoukup(fp *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY);
+
+/* two-way search from the current forehead (routed tree) of wire #wireNum and from its     *
+ * nearest unrouted target (Manhattan distance), the smaller forehead is expanded each step. *
+ * when the waves meet, the backward part of a shortest path gets forward wave values,      *
+ * hence fpTraceback works. returns:- 0: waves have not met, 2: target found                 */
+int                 fpWaveTwoWay(fp *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY);
+
+/* incremental Lee-Moore search of wire #wireNum: the distance field from the routed tree and *
+ * its open cells (f->bq) are kept between the targets of the wire. a search expands cells in *
+ * distance order only up to the nearest unrouted target; the next one seeds the tree cells   *
+ * added by the last traceback with distance 0 and continues, a cell is queued again only if  *
+ * it gets a shorter distance (decrease-only repair). the target is chosen as fpWaveExpand    *
+ * would choose it. returns:- 0: no target is reachable, 2: target found                      */
+int                 fpWaveIncremental(fp *f,unsigned int wireNum, unsigned int *targetX, unsigned int *targetY);
+
+/* check the wave of the current search against a Lee-Moore search (fpWaveExpand) from    *
+ * the same forehead. expRes and (tarX,tarY) are the results of the checked engine.       *
+ * bitboard waves must match tile by tile; A* and Hadlock must find a target at the same  *
+ * distance and their visited tiles must have Lee-Moore values (shortest distances) where *
+ * Lee-Moore has any. the checked wave is restored for traceback. returns mismatches     */
+unsigned int        fpWaveCheck(fp *f, unsigned int wireNum, int expRes, unsigned int tarX, unsigned int tarY);
+
+/* set the search window of wire #wireNum to the bounding box of its pins and routed tree     *
+ * (f->treeCell) widened by margin tiles on each side and clipped to the grid; a negative    *
+ * margin sets the whole grid. returns 1 if the window is smaller than the grid, 0 otherwise */
+int                 fpSetWindow(fp *f, unsigned int wireNum, int margin);
+
 /* route wire #wireNum to any avaliable unrouted target            *
  *	returns:- 0: Source could not be routed to any relevant target *
  *	          1: Source has been routed to a relevant target       */
@@ -134,24 +486,39 @@ void                fpTraceback(fp *f, unsigned int tarX, unsigned int tarY,
  * returns 1 if routeable, 0 other wise   */
 int                 fpRouteWire(fp *f, unsigned int wireNum);
 
-/* ripup wire #wireNum */
+/* route wire #wireNum inside region columns x0 to x1 and rows y0 to y1, which holds its pins:   *
+ * searches, tracebacks and the ripup of a failed wire stay inside it. views of a floorplan may *
+ * route wires concurrently if their regions widened by one tile do not overlap                *
+ * returns 1 if routeable, 0 other wise                                                         */
+int                 fpRouteWireRegion(fp *f, unsigned int wireNum, unsigned int x0, unsigned int x1,
+                                                                   unsigned int y0, unsigned int y1);
+
+/* ripup wire #wireNum, only the routed tree cells are visited if the tree of the wire is tracked */
 void                fpRipupWire(fp *f, unsigned int wireNum);
 
 /* route all wires in floorplan, returns the amount of successfully routed wires*/
 int fpRouteAll(fp  *f);
 
-/* order floorplan wires by their bbox area, f->routerOrder holds the ordered indexes */
+/* order floorplan wires by the key chosen by orderMode, f->routerOrder holds the ordered indexes */
 void                fpOrderWireByBBox(fp *f);
 
 /* for each wire, count how many it tackles a wave expansion form (expX,expY) *
  *  results for each wire are located in f->ripCnt                            */
 void                fpCountBlockage(fp *f, unsigned int expX, unsigned int expY);
 
+/* count into cnt (zero on entry) how many times each wire tackles a wave expansion from (expX,expY), *
+ * the wires that tackle it are listed in hit (unless NULL). returns the number of these wires       */
+unsigned int        fpCountBlockers(fp *f, unsigned int expX, unsigned int expY, unsigned int *cnt, unsigned int *hit);
+
 /* find the maximum blocking wire to wire #wireNum                          *
  * try to expand from the source and each target of wire #wireNum           *
  * if one wire tackles the expansion, it's blocking and should be ripped-up *
  * if more than one wire tackles the expansion, choose the maximum blocking */
 unsigned int        fpFindBlockingWire(fp *f, unsigned int wireNum);
 
+/* benchmark the grid layout (FP_LAYOUT): a Lee-Moore wave (fpWaveExpand) floods an empty    *
+ * size X size grid from its center, the expanded tiles and the run time are printed (-grid) */
+void                fpWaveBench(unsigned int size);
+
 #endif /* __FLOORPLAN_HEADER__ */
 
@@ -39,7 +39,9 @@
 #include <time.h>
 #include <limits.h>
 #include <ctype.h>
+#ifndef HEADLESS
 #include "graphics.h"
+#endif
 #include "common.h"
 #include "floorplan.h"
 #include "array.h"
@@ -54,6 +56,26 @@ int verbose=0;          /* verbose status
 int psEnable=0;		    /* enable PostScript creation                                                 */
 char tracebackMode='M'; /* tracebback mode:- M: Minturn, D: Direct                                    */
 char steppingMode='W';  /* Routing steps:- W: Wave, D: Destination, N: Net, R: Route all mode         */
+char searchMode='L';    /* search engine:- L: Lee-Moore, B: Bitboard, A: A*, H: Hadlock, S: Soukup,   */
+                        /*                 P: frontier-parallel Lee-Moore by -jobs threads            */
+int checkMode=0;        /* check wave labels of other search engines against Lee-Moore expansion      */
+int twoWay=0;           /* two-way (source and target) wave search for the first target of each wire  */
+int winMargin=-1;       /* search window margin around net bounding box, -1: whole grid               */
+int incremental=0;      /* keep the Lee-Moore distance field between targets of a wire and repair it  */
+int jobs=1;             /* routing threads for disjoint wires and ripup probes, 1: sequential routing */
+int lookahead=0;        /* wires routed speculatively at once by the threads, 0: disjoint batches     */
+int frontierAlpha=0;    /* bottom-up wave steps when forehead*alpha exceeds unlabelled tiles, 0: off  */
+int frontierBeta=0;     /* top-down wave steps again when forehead*beta is below the window area      */
+char orderMode='A';     /* routing order:- A: bbox Area, H: Half perimeter, P: Pins, C: Criticality   */
+int residue=0;          /* wave values stored as 2-bit labels mod 3, traceback follows the residues   */
+int benchGrid=0;        /* grid layout benchmark on an empty NxN grid instead of routing, 0: off      */
+#ifdef HEADLESS
+int batchMode=1;        /* batch mode: no display, no stepping (always on in headless build)          */
+#else
+int batchMode=0;        /* batch mode: no display, no stepping                                        */
+#endif
+
+#ifndef HEADLESS
 
 /* functions associated with buttons                                                                  */
 inline void waveModeFunc(void (*drawScreen_ptr) (void)) {steppingMode='W';} /* show wave expansion    */
@@ -79,6 +101,7 @@ void waitLoop () {
 	drawScreen();
 	update_message(glabel);
 }
+#endif /* HEADLESS */
 
 
 /***********************************************  main  ***********************************************
@@ -86,6 +109,37 @@ void waitLoop () {
  *           -help       (or -h) : print command usage help                                           *
  *           -verbose    (or -v) : enables verbose logging mode                                       *
  *           -postscript (or -p) : enables PostScript plotting                                        *
+ *           -batch      (or -b) : route without display and stepping, print results only             *
+ *           -search     (or -e) : choose wave search engine, followed by one of the following:       *
+ *                                 lee         (or l) : Lee-Moore grid expansion (default)            *
+ *                                 bitboard    (or b) : Lee-Moore expansion on packed 64-tile words   *
+ *                                 astar       (or a) : goal-directed search toward nearest target    *
+ *                                 hadlock     (or h) : minimum detour search toward nearest target   *
+ *                                 soukup      (or s) : line probes first, not always shortest        *
+ *                                 parallel    (or p) : Lee-Moore levels expanded by -jobs threads    *
+ *           -check      (or -c) : check wave labels of the search engine against Lee-Moore           *
+ *           -twoway     (or -w) : two-way search from source and nearest target for first targets    *
+ *           -margin     (or -m) : search in net bounding box plus margin, doubled on failure         *
+ *                                 nets left unrouted are routed again one by one in the whole grid   *
+ *           -incremental(or -i) : keep Lee-Moore distances between targets of a net, repair them     *
+ *           -frontier   (or -f) : followed by ALPHA BETA, Lee-Moore wave steps turn bottom-up when   *
+ *                                 forehead*ALPHA exceeds unlabelled tiles, top-down again when       *
+ *                                 forehead*BETA is below the search window area (e.g. 14 24)         *
+ *                                 -verbose reports the numbers of top-down and bottom-up steps       *
+ *           -residue    (or -r) : store wave values as 2-bit labels mod 3, traceback follows the     *
+ *                                 decreasing residues (lee, bitboard and parallel engines only)      *
+ *           -jobs       (or -j) : route spatially disjoint nets by N threads (batch mode only)       *
+ *                                 infiles over 8MB are parsed in chunks by up to N threads           *
+ *                                 routed nets may differ from -jobs 1, except with -search parallel  *
+ *           -lookahead  (or -l) : with -jobs, route next N nets at once in their regions and commit  *
+ *                                 them in order, reroute nets that collide with an earlier commit    *
+ *           -grid       (or -g) : followed by N, flood an empty NxN grid by a Lee-Moore wave and     *
+ *                                 report the time of the grid layout (make LAYOUT=...), no infile    *
+ *           -order      (or -o) : choose net routing order, followed by one of the following:        *
+ *                                 area        (or a) : smallest bounding box area first (default)    *
+ *                                 halfperim   (or h) : smallest bounding box half perimeter first    *
+ *                                 pins        (or p) : fewest pins first                             *
+ *                                 criticality (or c) : longest nets first                            *
  *           -stepping   (or -s) : choose stepping mode, should be followed by one of the following:  *
  *                                 wave        (or w) : shows wave expansion (default)                *
  *                                 destination (or d) : shows routing of each destination             *
@@ -97,10 +151,14 @@ int main(int argc, char *argv[]) {
 	/* arguments parsing */
 	int argi; /* arguments index */
 	int fileNameArgInd=-1; /* file name argument index */
-	char psm,sm,tbm;
+	char psm,sm,tbm,em,om;
+	char opt; /* option letter */
+	int routed;
 	for(argi=1;argi<argc;argi++) { /* check all argument */
 		if (argv[argi][0]=='-') { /* switch argument */
-			switch (tolower(argv[argi][1])) { /* consider first letter */
+			opt = tolower(argv[argi][1]);
+			if ((opt=='s')&&(tolower(argv[argi][2])=='e')) opt='e'; /* -search, not -stepping */
+			switch (opt) { /* consider first letter */
 
 				/* help */
 				case 'h':	printf("Lee-Moore Shortest Path Maze Router\n");
@@ -110,9 +168,36 @@ int main(int argc, char *argv[]) {
 							printf("\t-help       (also -h): print this message\n");
 							printf("\t-verbose    (also -v): verbose logging\n");
 							printf("\t-postscript (also -p): generate PostScript every step\n");
+							printf("\t-batch      (also -b): route without display or stepping, print results only\n");
 							printf("\t-traceback  (also -t): traceback mode, followed by one of the following\n");
 							printf("\t\tminturn     (also m): avoid turns, try to keep same direction (default)\n");
 							printf("\t\tdirect      (also d): use direct paths toward source\n");
+							printf("\t-search     (also -e): wave search engine, followed by one of the following\n");
+							printf("\t\tlee         (also l): Lee-Moore grid expansion (default)\n");
+							printf("\t\tbitboard    (also b): Lee-Moore expansion on packed 64-tile words\n");
+							printf("\t\tastar       (also a): goal-directed search toward nearest target\n");
+							printf("\t\thadlock     (also h): minimum detour search toward nearest target\n");
+							printf("\t\tsoukup      (also s): line probes first, not always shortest\n");
+							printf("\t\tparallel    (also p): Lee-Moore levels expanded by -jobs threads\n");
+							printf("\t-check      (also -c): check wave labels of the search engine against Lee-Moore\n");
+							printf("\t-twoway     (also -w): two-way search from source and nearest target for first targets\n");
+							printf("\t-margin N   (also -m): search inside net bounding box plus margin N, doubled on failure\n");
+							printf("\t                       nets left unrouted are routed again one by one in the whole grid\n");
+							printf("\t-incremental(also -i): keep Lee-Moore distances between targets of a net and repair them\n");
+							printf("\t-frontier A B(also -f): bottom-up Lee-Moore wave steps for foreheads over 1/A of unlabelled\n");
+							printf("\t                       tiles, top-down again for foreheads under 1/B of the window (e.g. 14 24)\n");
+							printf("\t                       -verbose reports the numbers of top-down and bottom-up steps\n");
+							printf("\t-residue    (also -r): store wave values as 2-bit labels mod 3 (lee, bitboard, parallel)\n");
+							printf("\t-jobs N     (also -j): route spatially disjoint nets by N threads (batch mode only)\n");
+							printf("\t                       infiles over 8MB are parsed in chunks by up to N threads\n");
+							printf("\t                       routed nets may differ from -jobs 1, except with -search parallel\n");
+							printf("\t-lookahead N(also -l): with -jobs, route next N nets at once and commit them in order\n");
+							printf("\t-grid N     (also -g): time a Lee-Moore wave flooding an empty NxN grid, no infile needed\n");
+							printf("\t-order      (also -o): net routing order, followed by one of the following\n");
+							printf("\t\tarea        (also a): smallest bounding box area first (default)\n");
+							printf("\t\thalfperim   (also h): smallest bounding box half perimeter first\n");
+							printf("\t\tpins        (also p): fewest pins first\n");
+							printf("\t\tcriticality (also c): longest nets first\n");
 							printf("\t-stepping   (also -s): stepping mode, followed by one of the following\n");
 							printf("\t\twave        (also w): wave expansion (default)\n");
 							printf("\t\tdestination (also d): route one destination at once\n");
@@ -134,6 +219,7 @@ int main(int argc, char *argv[]) {
 							printf("\tmaze a.infile (using default options)\n");
 							printf("\tmaze a.infile -verbose -postscript -stepping destination\n");
 							printf("\tmaze a.infile -v -p -s d (same as above)\n");
+							printf("\tmaze a.infile -batch (no X display needed)\n");
 							printf("Report bugs to <ameer.abdelhadi@gmail.com>\n");
 							return(1);
 
@@ -145,6 +231,89 @@ int main(int argc, char *argv[]) {
 				case 'p':	psEnable=1;			/* enable ps creation */
 							break;
 
+				/* batch mode */
+				case 'b':	batchMode=1;		/* no display */
+							break;
+
+				/* wave search engine, -search, or -e */
+				case 'e':	argi++;												/* next argument */
+							if (argi>=argc) em = 'X';							/* if index is out of range, exit */
+								else em = toupper(argv[argi][0]);
+							if ((em!='L')&&(em!='B')&&(em!='A')&&(em!='H')&&(em!='S')&&(em!='P')) {	/* consider first letter */
+								printf("-E- search engines are: lee, bitboard, astar, hadlock, soukup, parallel! Exiting...\n");
+								exit(-1);
+							} else searchMode=em;
+							break;
+
+				/* check mode */
+				case 'c':	checkMode=1;		/* check wave labels */
+							break;
+
+				/* two-way search */
+				case 'w':	twoWay=1;			/* first target of each wire */
+							break;
+
+				/* search window margin */
+				case 'm':	argi++;												/* next argument */
+							if ((argi>=argc) || (!isdigit(argv[argi][0]))) {	/* non-negative number */
+								printf("-E- search window margin should be a non-negative number! Exiting...\n");
+								exit(-1);
+							} else winMargin=atoi(argv[argi]);
+							break;
+
+				/* incremental search */
+				case 'i':	incremental=1;		/* keep distance field between targets */
+							break;
+
+				/* direction-optimizing wave steps */
+				case 'f':	argi+=2;											/* next two arguments */
+							if ((argi>=argc) || (atoi(argv[argi-1])<1) || (atoi(argv[argi])<1)) {	/* positive numbers */
+								printf("-E- frontier thresholds ALPHA and BETA should be positive numbers! Exiting...\n");
+								exit(-1);
+							} else {
+								frontierAlpha=atoi(argv[argi-1]);
+								frontierBeta =atoi(argv[argi]);
+							}
+							break;
+
+				/* residue wave labels */
+				case 'r':	residue=1;			/* 2-bit labels mod 3 */
+							break;
+
+				/* routing threads */
+				case 'j':	argi++;												/* next argument */
+							if ((argi>=argc) || (atoi(argv[argi])<1)) {			/* positive number */
+								printf("-E- number of jobs should be a positive number! Exiting...\n");
+								exit(-1);
+							} else jobs=atoi(argv[argi]);
+							break;
+
+				/* speculative routing */
+				case 'l':	argi++;												/* next argument */
+							if ((argi>=argc) || (atoi(argv[argi])<1)) {			/* positive number */
+								printf("-E- lookahead should be a positive number! Exiting...\n");
+								exit(-1);
+							} else lookahead=atoi(argv[argi]);
+							break;
+
+				/* grid layout benchmark */
+				case 'g':	argi++;												/* next argument */
+							if ((argi>=argc) || (atoi(argv[argi])<1)) {			/* positive number */
+								printf("-E- benchmark grid size should be a positive number! Exiting...\n");
+								exit(-1);
+							} else benchGrid=atoi(argv[argi]);
+							break;
+
+				/* net routing order */
+				case 'o':	argi++;												/* next argument */
+							if (argi>=argc) om = 'X';							/* if index is out of range, exit */
+								else om = toupper(argv[argi][0]);
+							if ((om!='A')&&(om!='H')&&(om!='P')&&(om!='C')) {	/* consider first letter */
+								printf("-E- routing orders are: area, halfperim, pins, criticality! Exiting...\n");
+								exit(-1);
+							} else orderMode=om;
+							break;
+
 				/* stepping mode */
 				case 's':	argi++;												/* next argument */
 							if (argi>=argc) sm = 'X';							/* if index is out of range, exit */
@@ -172,12 +341,52 @@ int main(int argc, char *argv[]) {
 		} else fileNameArgInd = argi; /* file name argument index */
 	}
 
+	/* incremental search is a Lee-Moore search from the whole routed tree */
+	if (incremental && ((searchMode!='L') || twoWay)) {
+		printf("-E- incremental search works with lee search engine only, without two-way search! Exiting...\n");
+		exit(-1);
+	}
+
+	/* bottom-up steps replace the levels of the Lee-Moore expansion */
+	if (frontierAlpha && ((searchMode!='L') || incremental)) {
+		printf("-E- frontier switching works with lee search engine only, without incremental search! Exiting...\n");
+		exit(-1);
+	}
+
+	/* residue labels are exact for level by level expansions only, the check compares full values */
+	if (residue && (((searchMode!='L')&&(searchMode!='B')&&(searchMode!='P')) || twoWay || incremental || checkMode)) {
+		printf("-E- residue labels work with lee, bitboard and parallel search engines only, without two-way, incremental search or wave check! Exiting...\n");
+		exit(-1);
+	}
+
+	/* routing threads neither step the display nor share the wave check, *
+	 * parallel search engine threads expand the waves of a single wire    */
+	if ((jobs>1) && (searchMode!='P') && ((!batchMode) || checkMode)) {
+		printf("-E- parallel routing works in batch mode only, without wave check! Exiting...\n");
+		exit(-1);
+	}
+
+	/* grid layout benchmark, no routing */
+	if (benchGrid) {
+		fpWaveBench(benchGrid);
+		return 0;
+	}
+
 	/* check if infile is supplied */
 	if (fileNameArgInd<0) {printf(" -E- infile should be supplied\n"); exit(-1);}
 
 	/* parse input file into floorplan database */
 	gfp = fpInfileParse(argv[fileNameArgInd]);
 
+	/* batch mode: route all pins, report and exit without display */
+	if (batchMode) {
+		routed = fpRouteAll(gfp);
+		printf("-I- Routing finished! %d out of %u wires have been routed successfully!\n",routed,gfp->wireNum);
+		fpDelete(gfp);
+		return 0;
+	}
+
+#ifndef HEADLESS
 	/* initialize display with WHITE 1000x1000 background */
 	init_graphics((char*)"Lee-Moore Shortest Path Maze Router", WHITE, NULL);
 	init_world (0.,0.,1000.,1000.);
@@ -202,5 +411,6 @@ int main(int argc, char *argv[]) {
 
 	/* free database */
 	fpDelete(gfp);
+#endif /* HEADLESS */
 
 }
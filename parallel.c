@@ -0,0 +1,865 @@
+/***********************************************************************************
+** Copyright (c) 2011, University of British Columbia (UBC); All rights reserved. **
+**                                                                                **
+** Redistribution  and  use  in  source   and  binary  forms,   with  or  without **
+** modification,  are permitted  provided that  the following conditions are met: **
+**   * Redistributions   of  source   code  must  retain   the   above  copyright **
+**     notice,  this   list   of   conditions   and   the  following  disclaimer. **
+**   * Redistributions  in  binary  form  must  reproduce  the  above   copyright **
+**     notice, this  list  of  conditions  and the  following  disclaimer in  the **
+**     documentation and/or  other  materials  provided  with  the  distribution. **
+**   * Neither the name of the University of British Columbia (UBC) nor the names **
+**     of   its   contributors  may  be  used  to  endorse  or   promote products **
+**     derived from  this  software without  specific  prior  written permission. **
+**                                                                                **
+** THIS  SOFTWARE IS  PROVIDED  BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" **
+** AND  ANY EXPRESS  OR IMPLIED WARRANTIES,  INCLUDING,  BUT NOT LIMITED TO,  THE **
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE **
+** DISCLAIMED.  IN NO  EVENT SHALL University of British Columbia (UBC) BE LIABLE **
+** FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL **
+** DAMAGES  (INCLUDING,  BUT NOT LIMITED TO,  PROCUREMENT OF  SUBSTITUTE GOODS OR **
+** SERVICES;  LOSS OF USE,  DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER **
+** CAUSED AND ON ANY THEORY OF LIABILITY,  WHETHER IN CONTRACT, STRICT LIABILITY, **
+** OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE **
+** OF  THIS SOFTWARE,  EVEN  IF  ADVISED  OF  THE  POSSIBILITY  OF  SUCH  DAMAGE. **
+***********************************************************************************/
+
+/***********************************************************************************
+** parallel.c: parallel routing of wires and parallel ripup blockage probes       **
+**                                                                                **
+**    Author: Ameer M. Abdelhadi (ameer@ece.ubc.ca, ameer.abdelhadi@gmail.com)    **
+**                University of British Columbia (UBC), Feb. 2011                 **
+***********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <ctype.h>
+#include <pthread.h>
+#include "floorplan.h"
+#ifndef HEADLESS
+#include "graphics.h"
+#endif
+#include "bitboard.h"
+#include "common.h"
+#include "array.h"
+#include "parallel.h"
+
+/* state shared by the routing threads */
+struct parStr {
+	fp           *f;        /* routed floorplan, its grid holds the committed wires            */
+	fp          **view;     /* floorplan view of each thread                                  */
+	struct parThread *thr;  /* thread arguments                                               */
+	pthread_t    *tid;      /* thread ids, thread 0 is the calling thread                     */
+	unsigned int  jobs;     /* number of threads                                              */
+	int           spec;     /* speculative routing: views route on own copy of each region   */
+	unsigned int *batch;    /* wires of the current batch, in routing order                    */
+	unsigned int *region;   /* routing region of each batch wire: x0, x1, y0, y1              */
+	char         *routed;   /* routing result of each batch wire                               */
+	gridInd     **cell;     /* speculative: routed tree cells of each batch wire               */
+	gridInd      *cellNum;  /* speculative: number of cells in cell                            */
+	gridInd      *cellCap;  /* speculative: allocated size of cell                             */
+	unsigned int  batchNum; /* number of wires in batch                                        */
+	unsigned int  next;     /* next batch wire to route, taken by atomic increment             */
+	int           done;     /* no more batches, threads exit                                   */
+	pthread_barrier_t bar;  /* all threads meet at batch start and batch end                   */
+};
+
+/* routing thread argument */
+struct parThread {
+	struct parStr *p;       /* shared state        */
+	unsigned int   id;      /* thread (view) index */
+};
+
+/* route batch wire #k speculatively in view v, which holds private grid cells: the region of *
+ * the wire widened by one tile is copied from the committed grid of f and the wire is routed  *
+ * inside it (fpRouteWireRegion), cells out of the region are never read. keep the routed tree *
+ * cells of the wire, the next copy over the region overwrites them in the view                */
+static void parSpeculate(struct parStr *p, fp *v, unsigned int k) {
+	unsigned int *r = p->region+4*k;
+	unsigned int iCol, iRow, x0, x1, y0, y1, c;
+	gridInd i, at;
+	x0 = (r[0] > 0) ? r[0]-1 : 0; x1 = MIN(r[1]+1,v->col-1);
+	y0 = (r[2] > 0) ? r[2]-1 : 0; y1 = MIN(r[3]+1,v->row-1);
+	for (iRow=y0;iRow<=y1;iRow++) {
+		for (iCol=x0;iCol<=x1;iCol++) {	/* empty cells over empty ones leave the zero block */
+			at = fpAt(v,iCol,iRow);
+			c  = FP_MAP(p->f->cell,at);
+			if (c != FP_MAP(v->cell,at)) *FP_MAP_W(v->cell,at) = c;
+		}
+	}
+	p->routed[k] = fpRouteWireRegion(v,p->batch[k],r[0],r[1],r[2],r[3]);
+	if (!p->routed[k]) return;	/* failed wire is ripped-up already */
+	if (p->cellCap[k] < v->treeNum) {
+		p->cellCap[k] = v->treeNum;
+		p->cell[k] = (gridInd*)safeRealloc(p->cell[k],sizeof(gridInd)*p->cellCap[k]);
+	}
+	for (i=0;i<v->treeNum;i++) p->cell[k][i] = v->treeCell[i];
+	p->cellNum[k] = v->treeNum;
+}
+
+/* route wires of the current batch in view v until none is left */
+static void parRouteBatch(struct parStr *p, fp *v) {
+	unsigned int k, *r;
+	while ((k = __sync_fetch_and_add(&p->next,1)) < p->batchNum) {
+		if (p->spec) parSpeculate(p,v,k);
+		else {
+			r = p->region+4*k;
+			p->routed[k] = fpRouteWireRegion(v,p->batch[k],r[0],r[1],r[2],r[3]);
+		}
+	}
+}
+
+/* routing thread: route each batch in own view */
+static void *parWorker(void *arg) {
+	struct parThread *t = (struct parThread*)arg;
+	struct parStr *p = t->p;
+	for (;;) {
+		pthread_barrier_wait(&p->bar);	/* batch start */
+		if (p->done) break;
+		parRouteBatch(p,p->view[t->id]);
+		pthread_barrier_wait(&p->bar);	/* batch end */
+	}
+	return NULL;
+}
+
+/* start jobs routing threads with a view of f each (private grid cells if spec is set), *
+ * batches hold up to batchCap wires. the calling thread is thread 0                     */
+static void parStart(struct parStr *p, fp *f, unsigned int jobs, int spec, unsigned int batchCap) {
+	unsigned int i;
+	if (searchMode == 'B') bbKernel();	/* select bitboard kernel before threads use it */
+	p->f        = f;
+	p->jobs     = jobs;
+	p->spec     = spec;
+	p->done     = 0;
+	p->batchNum = 0;
+	p->batch    = (unsigned int*)safeMalloc(sizeof(unsigned int)*batchCap);
+	p->region   = (unsigned int*)safeMalloc(sizeof(unsigned int)*4*batchCap);
+	p->routed   = (char*        )safeMalloc(sizeof(char)*batchCap);
+	p->cell     = (gridInd**    )safeMalloc(sizeof(gridInd*)*batchCap);
+	p->cellNum  = (gridInd*     )safeMalloc(sizeof(gridInd)*batchCap);
+	p->cellCap  = (gridInd*     )safeMalloc(sizeof(gridInd)*batchCap);
+	for (i=0;i<batchCap;i++) {p->cell[i] = NULL; p->cellCap[i] = 0;}
+	p->view     = (fp**         )safeMalloc(sizeof(fp*)*jobs);
+	p->thr      = (struct parThread*)safeMalloc(sizeof(struct parThread)*jobs);
+	p->tid      = (pthread_t*   )safeMalloc(sizeof(pthread_t)*jobs);
+	pthread_barrier_init(&p->bar,NULL,jobs);
+	for (i=0;i<jobs;i++) {
+		p->view[i]   = fpCreateView(f,spec);
+		p->thr[i].p  = p;
+		p->thr[i].id = i;
+	}
+	for (i=1;i<jobs;i++) {
+		if (pthread_create(&p->tid[i],NULL,parWorker,&p->thr[i]) != 0) {
+			printf("-E- routing thread creation failed! Exiting...\n");
+			exit(-1);
+		}
+	}
+}
+
+/* route the current batch by all threads */
+static void parRun(struct parStr *p) {
+	p->next = 0;
+	pthread_barrier_wait(&p->bar);
+	parRouteBatch(p,p->view[0]);
+	pthread_barrier_wait(&p->bar);
+}
+
+/* stop routing threads, add statistics of the views to f and free them */
+static void parStop(struct parStr *p, fp *f, unsigned int batchCap) {
+	unsigned int i;
+	p->done = 1;
+	pthread_barrier_wait(&p->bar);
+	for (i=1;i<p->jobs;i++) pthread_join(p->tid[i],NULL);
+	pthread_barrier_destroy(&p->bar);
+	for (i=0;i<p->jobs;i++) {
+		f->visitCnt += p->view[i]->visitCnt;
+		f->tdSteps  += p->view[i]->tdSteps;
+		f->buSteps  += p->view[i]->buSteps;
+		f->arenaHigh = MAX(f->arenaHigh,p->view[i]->arena->high);
+		fpDelete(p->view[i]);
+	}
+	for (i=0;i<batchCap;i++) if (p->cell[i] != NULL) safeFree(p->cell[i]);
+	safeFree(p->batch);
+	safeFree(p->region);
+	safeFree(p->routed);
+	safeFree(p->cell);
+	safeFree(p->cellNum);
+	safeFree(p->cellCap);
+	safeFree(p->view);
+	safeFree(p->thr);
+	safeFree(p->tid);
+}
+
+/* move the routed wires (order, routedNum of them) to the front of f->routeOrder, *
+ * followed by the others in their original order (ok is set for routed wires)    */
+static void parReorder(fp *f, unsigned int *order, unsigned int routedNum, char *ok) {
+	unsigned int i, k;
+	for (i=0,k=routedNum;i<f->wireNum;i++) {
+		if (!ok[f->routeOrder[i]]) order[k++] = f->routeOrder[i];
+	}
+	memcpy(f->routeOrder,order,sizeof(unsigned int)*f->wireNum);
+}
+
+/* set region r (x0, x1, y0, y1) of wire #wireNum: bounding box of its pins widened by margin, *
+ * clipped to the grid                                                                       */
+static void parRegion(fp *f, unsigned int wireNum, unsigned int margin, unsigned int *r) {
+	unsigned int i;
+	unsigned int x0=f->srcX[wireNum], x1=x0, y0=f->srcY[wireNum], y1=y0;
+	for (i=0;i<f->dstNum[wireNum];i++) {
+		x0 = MIN(x0,f->dstX[wireNum][i]); x1 = MAX(x1,f->dstX[wireNum][i]);
+		y0 = MIN(y0,f->dstY[wireNum][i]); y1 = MAX(y1,f->dstY[wireNum][i]);
+	}
+	r[0] = (x0 > margin) ? x0-margin : 0;
+	r[1] = (f->col-1-x1 > margin) ? x1+margin : f->col-1;
+	r[2] = (y0 > margin) ? y0-margin : 0;
+	r[3] = (f->row-1-y1 > margin) ? y1+margin : f->row-1;
+}
+
+/* route the wires of f->routeOrder by jobs threads, in batches of spatially disjoint wires: the  *
+ * routing region of a wire is the bounding box of its pins widened by a margin. wires are scanned *
+ * in routing order, a wire joins the batch if its region (plus one tile) does not overlap the     *
+ * region of an earlier scanned wire, hence overlapping wires keep their order. each thread routes *
+ * batch wires in its own view of f (fpRouteWireRegion). routed wires are moved to the front of    *
+ * f->routeOrder in routing order, wires that failed inside their region follow in their original *
+ * order. returns the number of routed wires                                                       */
+unsigned int parRouteDisjoint(fp *f, unsigned int jobs) {
+	struct parStr p;
+	unsigned int wnum=f->wireNum;
+	unsigned int tcols=(f->col+PAR_TILE-1)/PAR_TILE, trows=(f->row+PAR_TILE-1)/PAR_TILE;
+	gridInd tileNum=(gridInd)tcols*trows, busyNum;
+	unsigned int tx, ty, tx0, tx1, ty0, ty1;
+	unsigned int *pend, pendNum, keep;		/* wires not scheduled yet, in routing order */
+	unsigned int *order, routedNum=0;		/* routed wires in routing order             */
+	unsigned int i, k, w, r[4], batches=0;
+	char *busy, *ok;
+	unsigned int margin = (winMargin >= 0) ? (unsigned int)winMargin : PAR_MARGIN;
+	int overlap;
+
+	busy  = (char*        )safeMalloc(sizeof(char)*tileNum);
+	ok    = (char*        )safeMalloc(sizeof(char)*wnum);
+	pend  = (unsigned int*)safeMalloc(sizeof(unsigned int)*wnum);
+	order = (unsigned int*)safeMalloc(sizeof(unsigned int)*wnum);
+	parStart(&p,f,jobs,0,wnum);
+
+	for (i=0;i<wnum;i++) {pend[i] = f->routeOrder[i]; ok[i] = 0;}
+	pendNum = wnum;
+	while (pendNum > 0) {
+
+		/* next batch: scanned wires take the coarse tiles of their regions, *
+		 * a wire joins the batch if its tiles were free                    */
+		memset(busy,0,tileNum);
+		busyNum = 0;
+		p.batchNum = 0;
+		for (i=0,keep=0;i<pendNum;i++) {
+			w = pend[i];
+			if (busyNum == tileNum) {pend[keep++] = w; continue;}	/* all tiles taken */
+			parRegion(f,w,margin,r);
+			tx0 = ((r[0] > 0) ? r[0]-1 : 0)/PAR_TILE;	/* region and its neighbor tiles */
+			ty0 = ((r[2] > 0) ? r[2]-1 : 0)/PAR_TILE;
+			tx1 = MIN(r[1]+1,f->col-1)/PAR_TILE;
+			ty1 = MIN(r[3]+1,f->row-1)/PAR_TILE;
+			overlap = 0;
+			for (ty=ty0;ty<=ty1;ty++) {
+				for (tx=tx0;tx<=tx1;tx++) {
+					if (busy[(gridInd)ty*tcols+tx]) overlap = 1;
+					else {busy[(gridInd)ty*tcols+tx] = 1; busyNum++;}
+				}
+			}
+			if (overlap) pend[keep++] = w;
+			else {
+				p.batch[p.batchNum] = w;
+				memcpy(p.region+4*p.batchNum,r,sizeof(r));
+				p.batchNum++;
+			}
+		}
+		pendNum = keep;
+
+		/* route batch by all threads */
+		parRun(&p);
+		for (k=0;k<p.batchNum;k++) {
+			if (p.routed[k]) {
+				ok[p.batch[k]] = 1;
+				order[routedNum++] = p.batch[k];
+			}
+		}
+		batches++;
+	}
+
+	parStop(&p,f,wnum);
+	parReorder(f,order,routedNum,ok);
+	if (verbose) printf("-I- %u wires routed in %u batches of disjoint wires by %u threads, %u left for sequential routing\n",
+	                    routedNum,batches,jobs,wnum-routedNum);
+
+	safeFree(busy);
+	safeFree(ok);
+	safeFree(pend);
+	safeFree(order);
+	return routedNum;
+}
+
+/* commit batch wire #k: claim its routed tree cells in f (speculative mode) */
+static void parCommit(struct parStr *p, fp *f, unsigned int k) {
+	unsigned int w=p->batch[k], cols=f->col;
+	gridInd i, ind;
+	char cellType;
+	for (i=0;i<p->cellNum[k];i++) {
+		ind = p->cell[k][i];
+		cellType = fpGetCellType(f,ind%cols,ind/cols);
+		if (cellType == 'E') {					/* path tile */
+			fpSetCellType (f,ind%cols,ind/cols,'W');
+			fpSetCellValue(f,ind%cols,ind/cols,w);
+		} else fpSetCellType(f,ind%cols,ind/cols,tolower(cellType));	/* routed pins */
+	}
+}
+
+/* route the wires of f->routeOrder speculatively by jobs threads: each round, the next ahead   *
+ * wires are routed at once, each thread routes in its own view inside the region of the wire  *
+ * (pins bounding box widened by a margin) copied from the committed grid. the routed trees are *
+ * committed in routing order; a wire whose tree takes a tile claimed by an earlier commit of   *
+ * the round is routed again in the next round. routed wires are moved to the front of          *
+ * f->routeOrder in commit order, wires that failed inside their region follow in their         *
+ * original order. returns the number of routed wires                                           */
+unsigned int parRouteSpeculative(fp *f, unsigned int jobs, unsigned int ahead) {
+	struct parStr p;
+	unsigned int wnum=f->wireNum, cols=f->col;
+	unsigned int *pend, *next, *swp, pendNum, nextNum;	/* wires not routed yet, in routing order */
+	unsigned int *order, routedNum=0;				/* committed wires in commit order         */
+	unsigned int k, w, rounds=0, requeued=0;
+	gridInd i, ind;
+	char *ok, cellType;
+	unsigned int margin = (winMargin >= 0) ? (unsigned int)winMargin : PAR_MARGIN;
+	int conflict;
+
+	ok    = (char*        )safeMalloc(sizeof(char)*wnum);
+	pend  = (unsigned int*)safeMalloc(sizeof(unsigned int)*wnum);
+	next  = (unsigned int*)safeMalloc(sizeof(unsigned int)*wnum);
+	order = (unsigned int*)safeMalloc(sizeof(unsigned int)*wnum);
+	parStart(&p,f,jobs,1,ahead);
+
+	for (i=0;i<wnum;i++) {pend[i] = f->routeOrder[i]; ok[i] = 0;}
+	pendNum = wnum;
+	while (pendNum > 0) {
+
+		/* route next wires on the committed grid */
+		p.batchNum = MIN(ahead,pendNum);
+		for (k=0;k<p.batchNum;k++) {
+			p.batch[k] = pend[k];
+			parRegion(f,pend[k],margin,p.region+4*k);
+		}
+		parRun(&p);
+
+		/* commit in order, wires that collide with an earlier commit are routed again first */
+		nextNum = 0;
+		for (k=0;k<p.batchNum;k++) {
+			w = p.batch[k];
+			if (!p.routed[k]) continue;		/* no path in its region of the older grid: left for sequential routing */
+			for (i=0,conflict=0;(i<p.cellNum[k]) && (!conflict);i++) {
+				ind = p.cell[k][i];
+				cellType = fpGetCellType(f,ind%cols,ind/cols);
+				conflict = (cellType != 'E') && ( ((cellType != 'S') && (cellType != 'T')) ||
+				                                  (fpGetCellValue(f,ind%cols,ind/cols) != w) );
+			}
+			if (conflict) {
+				next[nextNum++] = w;
+				requeued++;
+			} else {
+				parCommit(&p,f,k);
+				ok[w] = 1;
+				order[routedNum++] = w;
+			}
+		}
+		for (i=p.batchNum;i<pendNum;i++) next[nextNum++] = pend[i];
+		swp = pend; pend = next; next = swp;
+		pendNum = nextNum;
+		rounds++;
+	}
+
+	parStop(&p,f,ahead);
+	parReorder(f,order,routedNum,ok);
+	if (verbose) printf("-I- %u wires routed speculatively in %u rounds by %u threads, %u re-routed after conflicts, %u left for sequential routing\n",
+	                    routedNum,rounds,jobs,requeued,wnum-routedNum);
+
+	safeFree(ok);
+	safeFree(pend);
+	safeFree(next);
+	safeFree(order);
+	return routedNum;
+}
+
+/* work-stealing deque of blockage probes of one thread: the owner pops from lo, thieves steal from hi */
+struct parDeque {
+	pthread_mutex_t lock;
+	unsigned int    lo;      /* next probe of the owner      */
+	unsigned int    hi;      /* one past the last probe      */
+};
+
+/* state shared by the blockage probe threads */
+struct parProbe {
+	fp             *f;       /* floorplan                                                   */
+	gridInd        *pin;     /* grid index of each unrouted pin of the wire, row-major order */
+	unsigned int    pinNum;  /* number of probes (pins)                                     */
+	unsigned int  **res;     /* blocking wires of each probe as (wire,count) pairs          */
+	unsigned int   *resNum;  /* number of blocking wires of each probe                      */
+	unsigned int    first;   /* first probe with a single blocking wire, pinNum if none     */
+	struct parDeque *dq;     /* probe deque of each thread                                  */
+	unsigned int    jobs;    /* number of threads                                           */
+};
+
+/* blockage probe thread argument */
+struct parProbeThread {
+	struct parProbe *q;      /* shared state        */
+	unsigned int     id;     /* thread (view) index */
+};
+
+/* take the next probe of thread id: own lowest first, otherwise steal the highest of another deque *
+ * returns UINT_MAX when all deques are empty                                                       */
+static unsigned int parTake(struct parProbe *q, unsigned int id) {
+	unsigned int i, k=UINT_MAX;
+	struct parDeque *d=&q->dq[id];
+	pthread_mutex_lock(&d->lock);
+	if (d->lo < d->hi) k = d->lo++;
+	pthread_mutex_unlock(&d->lock);
+	for (i=1;(k==UINT_MAX)&&(i<q->jobs);i++) {	/* steal */
+		d=&q->dq[(id+i)%q->jobs];
+		pthread_mutex_lock(&d->lock);
+		if (d->lo < d->hi) k = --d->hi;
+		pthread_mutex_unlock(&d->lock);
+	}
+	return k;
+}
+
+/* run blockage probes in view q->f->probeView[id] until no probe is left */
+static void *parProbeWorker(void *arg) {
+	struct parProbeThread *t = (struct parProbeThread*)arg;
+	struct parProbe *q = t->q;
+	fp *v = q->f->probeView[t->id];
+	unsigned int k, i, n, first;
+	while ((k=parTake(q,t->id)) != UINT_MAX) {
+		if (k > __sync_fetch_and_add(&q->first,0)) continue;	/* after the early exit, not needed */
+		n = fpCountBlockers(v,q->pin[k]%v->col,q->pin[k]/v->col,v->ripCnt,v->ripCntAcc);
+		q->res[k]    = (unsigned int*)arenaAlloc(v->arena,sizeof(unsigned int)*2*(n+1));	/* own arena */
+		q->resNum[k] = n;
+		for (i=0;i<n;i++) {
+			q->res[k][2*i  ] = v->ripCntAcc[i];
+			q->res[k][2*i+1] = v->ripCnt[v->ripCntAcc[i]];
+			v->ripCnt[v->ripCntAcc[i]] = 0;
+		}
+		if (n == 1) {	/* single blocking wire, lower the early exit */
+			do first = __sync_fetch_and_add(&q->first,0);
+			while ((k < first) && (__sync_val_compare_and_swap(&q->first,first,k) != first));
+		}
+	}
+	return NULL;
+}
+
+/* qsort order of grid indices, ascending (row-major) */
+static int parCompareInd(const void *a, const void *b) {
+	gridInd x=*(const gridInd*)a, y=*(const gridInd*)b;
+	return (x > y) - (x < y);
+}
+
+unsigned int parFindBlockingWire(fp *f, unsigned int wireNum, unsigned int jobs) {
+	struct parProbe q;
+	struct parProbeThread *thr;
+	pthread_t *tid;
+	unsigned int i, j, k, n, x, y, chunk;
+	unsigned int blockingWire;
+	char cellType;
+	unsigned int wnum=f->wireNum;
+	size_t mark=arenaMark(f->arena);	/* probe state is scratch memory of the calling thread */
+
+	/* unrouted pins of the wire, in the row-major order of the sequential scan */
+	n = f->dstNum[wireNum]+1;
+	q.pin = (gridInd*)arenaAlloc(f->arena,sizeof(gridInd)*n);
+	for (i=0,k=0;i<n;i++) {
+		x = (i==0) ? f->srcX[wireNum] : f->dstX[wireNum][i-1];
+		y = (i==0) ? f->srcY[wireNum] : f->dstY[wireNum][i-1];
+		cellType = fpGetCellType(f,x,y);
+		if (((cellType == 'S') || (cellType == 'T')) && (fpGetCellValue(f,x,y) == wireNum)) {
+			q.pin[k++] = (gridInd)y*f->col+x;
+		}
+	}
+	qsort(q.pin,k,sizeof(gridInd),parCompareInd);
+	for (i=0,j=0;i<k;i++) {	/* drop pins sharing a cell */
+		if ((j == 0) || (q.pin[i] != q.pin[j-1])) q.pin[j++] = q.pin[i];
+	}
+
+	/* blockage probe views are kept for the next ripups */
+	if (f->probeView == NULL) {
+		f->probeView = (fp**)safeMalloc(sizeof(fp*)*jobs);
+		for (i=0;i<jobs;i++) f->probeView[i] = fpCreateView(f,0);
+		f->probeNum = jobs;
+	}
+	for (i=0;i<jobs;i++) arenaReset(f->probeView[i]->arena);	/* results of the last probes */
+
+	/* deal the probes to the threads in contiguous chunks, idle threads steal */
+	q.f      = f;
+	q.pinNum = j;
+	q.first  = j;
+	q.jobs   = jobs;
+	q.res    = (unsigned int**)arenaAlloc(f->arena,sizeof(unsigned int*)*(j+1));
+	q.resNum = (unsigned int* )arenaAlloc(f->arena,sizeof(unsigned int )*(j+1));
+	for (i=0;i<j;i++) q.res[i] = NULL;
+	q.dq     = (struct parDeque*)arenaAlloc(f->arena,sizeof(struct parDeque)*jobs);
+	thr      = (struct parProbeThread*)arenaAlloc(f->arena,sizeof(struct parProbeThread)*jobs);
+	tid      = (pthread_t*)arenaAlloc(f->arena,sizeof(pthread_t)*jobs);
+	chunk    = (j+jobs-1)/jobs;
+	for (i=0;i<jobs;i++) {
+		pthread_mutex_init(&q.dq[i].lock,NULL);
+		q.dq[i].lo = (i*chunk < j) ? i*chunk : j;
+		q.dq[i].hi = ((i+1)*chunk < j) ? (i+1)*chunk : j;
+		thr[i].q   = &q;
+		thr[i].id  = i;
+	}
+	for (i=1;i<jobs;i++) {
+		if (pthread_create(&tid[i],NULL,parProbeWorker,&thr[i]) != 0) {
+			printf("-E- blockage probe thread creation failed! Exiting...\n");
+			exit(-1);
+		}
+	}
+	parProbeWorker(&thr[0]);
+	for (i=1;i<jobs;i++) pthread_join(tid[i],NULL);
+
+	/* merge in probe order: accumulate the probes before the early exit, as the sequential scan */
+	for (k=0;k<q.first;k++) {
+		for (i=0;i<q.resNum[k];i++) f->ripCntAcc[q.res[k][2*i]] += q.res[k][2*i+1];
+	}
+	if (q.first < q.pinNum) {
+		blockingWire = q.res[q.first][0];	/* the only blocking wire of that probe */
+	} else {
+		blockingWire = maxInd(f->ripCntAcc,wnum);	/* maximum blocking		*/
+		initArr(f->ripCntAcc,0,wnum);				/* init for next turn	*/
+		initArr(f->ripCnt,0,wnum);					/* init for next turn	*/
+	}
+
+	for (i=0;i<jobs;i++) pthread_mutex_destroy(&q.dq[i].lock);
+	arenaRelease(f->arena,mark);
+	return blockingWire;
+}
+
+/* frontier-parallel wave search state of a floorplan, threads wait at the barrier between levels */
+struct parWaveStr {
+	fp           *f;        /* searched floorplan                                             */
+	unsigned int  jobs;     /* number of threads                                              */
+	unsigned int  wireNum;  /* searched wire                                                  */
+	gridInd      *front;    /* current wave forehead, split into equal chunks by thread index */
+	gridInd       frontNum; /* number of cells in front                                       */
+	gridInd      *finder;   /* first forehead cell touching a target in each chunk            */
+	gridInd     **next;     /* new forehead cells claimed by each thread                      */
+	gridInd      *nextNum;  /* number of cells in next                                        */
+	gridInd      *nextCap;  /* allocated size of next                                         */
+	unsigned long long *visit; /* tiles expanded by each thread                                */
+	struct parWaveThread *thr; /* thread arguments                                            */
+	pthread_t    *tid;      /* thread ids, thread 0 is the calling thread                     */
+	int           done;     /* search threads exit                                            */
+	pthread_barrier_t bar;  /* all threads meet at the steps of each level                    */
+};
+
+/* wave search thread argument */
+struct parWaveThread {
+	struct parWaveStr *w;   /* shared state        */
+	unsigned int       id;  /* thread (chunk) index */
+};
+
+/* grid index of the unrouted target of wire #wireNum next to grid index ind, GRID_NONE if none; *
+ * neighbors are checked as fpWaveExpand does (right, left, down, up, the last found is taken)   */
+static gridInd parTouchTarget(fp *f, gridInd ind, unsigned int wireNum) {
+	unsigned int iCol=ind%f->col, iRow=ind/f->col;
+	unsigned int target=FP_CELL(FP_CELL_T,wireNum);	/* packed unrouted target cell of the wire */
+	if ((iRow > 0       ) && (FP_MAP(f->cell,fpAt(f,iCol,iRow-1)) == target)) return ind-f->col;
+	if ((iRow < f->row-1) && (FP_MAP(f->cell,fpAt(f,iCol,iRow+1)) == target)) return ind+f->col;
+	if ((iCol > 0       ) && (FP_MAP(f->cell,fpAt(f,iCol-1,iRow)) == target)) return ind-1;
+	if ((iCol < f->col-1) && (FP_MAP(f->cell,fpAt(f,iCol+1,iRow)) == target)) return ind+1;
+	return GRID_NONE;
+}
+
+/* wave value of storage index at, residue labels are loaded atomically since the other threads *
+ * store labels of tiles in the same word                                                       */
+static inline unsigned int parLoadWave(fp *f, gridInd at) {
+	unsigned int label;
+	if (f->waveMod == NULL) return FP_MAP(f->waveValue,at);
+	label = (__atomic_load_n(&f->waveMod[FP_BLOCK(at)][FP_MOD_WORD(at)],__ATOMIC_RELAXED) >> FP_MOD_SHIFT(at)) & 3;
+	return (label == FP_MOD_NONE) ? UINT_MAX : label;
+}
+
+/* store wave value waveValue of storage index at, residue labels by compare-and-swap of their word */
+static inline void parStoreWave(fp *f, gridInd at, unsigned int waveValue) {
+	unsigned int *word, old, shift;
+	if (f->waveMod == NULL) {*FP_MAP_W(f->waveValue,at) = waveValue; return;}
+	word  = fpBlockW(f->waveMod,FP_BLOCK(at),FP_MOD_BLOCK)+FP_MOD_WORD(at);	/* threads may race to allocate */
+	shift = FP_MOD_SHIFT(at);
+	do old = __atomic_load_n(word,__ATOMIC_RELAXED);
+	while (!__sync_bool_compare_and_swap(word,old,(old & ~(3u << shift)) | (FP_MOD_LABEL(waveValue) << shift)));
+}
+
+/* claim empty tile (iCol,iRow) for the new forehead of thread id with value waveValue: the tile *
+ * is taken by the thread whose compare-and-swap tags it as touched by the current search (its  *
+ * block is cleared first, fpWaveBlock). touched tiles are never unvisited during a Lee-Moore    *
+ * search (fpWaveSeed)                                                                          */
+static inline void parClaim(struct parWaveStr *w, unsigned int id, unsigned int iCol, unsigned int iRow, unsigned int waveValue) {
+	fp *f = w->f;
+	unsigned char *tag;
+	gridInd at=fpAt(f,iCol,iRow);
+	if (!FP_CELL_EMPTY(FP_MAP(f->cell,at))) return;
+	tag = fpWaveBlock(f,FP_BLOCK(at))+FP_BLOCK_OFF(at);	/* threads may race to allocate and clear */
+	if ( (__atomic_load_n(tag,__ATOMIC_RELAXED) == FP_WAVE_NEW) &&
+	     __sync_bool_compare_and_swap(tag,FP_WAVE_NEW,FP_WAVE_TAG(FP_WAVE_F)) ) {
+		parStoreWave(f,at,waveValue);
+		w->next[id][w->nextNum[id]++] = (gridInd)iRow*f->col+iCol;
+	}
+}
+
+/* expand the chunk of thread id of the current forehead by one level, as fpWaveExpand does:   *
+ * find the first cell touching a target, expand the cells up to it, and put the new forehead *
+ * into f->nxtFront in thread order                                                           */
+static void parWaveLevel(struct parWaveStr *w, unsigned int id) {
+	fp *f = w->f;
+	unsigned int cols=f->col;
+	unsigned int x0=f->winX0, x1=f->winX1, y0=f->winY0, y1=f->winY1; /* search window */
+	gridInd chunk=(w->frontNum+w->jobs-1)/w->jobs;
+	gridInd lo=MIN(id*chunk,w->frontNum), hi=MIN(lo+chunk,w->frontNum);
+	gridInd i, ind, finder, off, at;
+	unsigned int iCol, iRow, val;
+
+	/* first forehead cell of the chunk (row-major) that touches a target */
+	for (i=lo,finder=GRID_NONE;i<hi;i++) {
+		ind = w->front[i];
+		if ( (ind < finder) && (parTouchTarget(f,ind,w->wireNum) != GRID_NONE) ) finder = ind;
+	}
+	w->finder[id] = finder;
+	if (w->nextCap[id] < 4*(hi-lo)) {	/* each cell opens 4 neighbors at most */
+		w->nextCap[id] = 4*(hi-lo);
+		w->next[id] = (gridInd*)safeRealloc(w->next[id],sizeof(gridInd)*w->nextCap[id]);
+	}
+	w->nextNum[id] = 0;
+	pthread_barrier_wait(&w->bar);
+
+	/* expand up to the first finder of all chunks */
+	for (i=0;i<w->jobs;i++) finder = MIN(finder,w->finder[i]);
+	for (i=lo;i<hi;i++) {
+		ind = w->front[i];
+		if (ind > finder) continue;
+		iCol = ind%cols;
+		iRow = ind/cols;
+		at   = fpAt(f,iCol,iRow);
+		val  = parLoadWave(f,at);
+		w->visit[id]++;
+		if (iCol < x1) parClaim(w,id,iCol+1,iRow  ,val+1); /*Avoid window boundary*/
+		if (iCol > x0) parClaim(w,id,iCol-1,iRow  ,val+1); /*Avoid window boundary*/
+		if (iRow < y1) parClaim(w,id,iCol  ,iRow+1,val+1); /*Avoid window boundary*/
+		if (iRow > y0) parClaim(w,id,iCol  ,iRow-1,val+1); /*Avoid window boundary*/
+		__atomic_store_n(fpWaveBlock(f,FP_BLOCK(at))+FP_BLOCK_OFF(at),FP_WAVE_TAG(FP_WAVE_V),__ATOMIC_RELAXED);	/* read by parClaim */
+	}
+	pthread_barrier_wait(&w->bar);
+
+	/* concatenate the new foreheads */
+	for (i=0,off=0;i<id;i++) off += w->nextNum[i];
+	memcpy(f->nxtFront+off,w->next[id],sizeof(gridInd)*w->nextNum[id]);
+	pthread_barrier_wait(&w->bar);
+}
+
+/* wave search thread: expand a level each time the calling thread starts one */
+static void *parWaveWorker(void *arg) {
+	struct parWaveThread *t = (struct parWaveThread*)arg;
+	struct parWaveStr *w = t->w;
+	while (1) {
+		pthread_barrier_wait(&w->bar);
+		if (w->done) break;
+		parWaveLevel(w,t->id);
+	}
+	return NULL;
+}
+
+/* start the wave search threads of floorplan f */
+static struct parWaveStr *parWaveStart(fp *f, unsigned int jobs) {
+	unsigned int i;
+	struct parWaveStr *w = (struct parWaveStr*)safeMalloc(sizeof(struct parWaveStr));
+	w->f       = f;
+	w->jobs    = jobs;
+	w->done    = 0;
+	w->finder  = (gridInd* )safeMalloc(sizeof(gridInd )*jobs);
+	w->next    = (gridInd**)safeMalloc(sizeof(gridInd*)*jobs);
+	w->nextNum = (gridInd* )safeMalloc(sizeof(gridInd )*jobs);
+	w->nextCap = (gridInd* )safeMalloc(sizeof(gridInd )*jobs);
+	w->visit   = (unsigned long long*)safeMalloc(sizeof(unsigned long long)*jobs);
+	w->thr     = (struct parWaveThread*)safeMalloc(sizeof(struct parWaveThread)*jobs);
+	w->tid     = (pthread_t*    )safeMalloc(sizeof(pthread_t)*jobs);
+	pthread_barrier_init(&w->bar,NULL,jobs);
+	for (i=0;i<jobs;i++) {
+		w->next[i]    = NULL;
+		w->nextCap[i] = 0;
+		w->visit[i]   = 0;
+		w->thr[i].w   = w;
+		w->thr[i].id  = i;
+	}
+	for (i=1;i<jobs;i++) {
+		if (pthread_create(&w->tid[i],NULL,parWaveWorker,&w->thr[i]) != 0) {
+			printf("-E- wave search thread creation failed! Exiting...\n");
+			exit(-1);
+		}
+	}
+	return w;
+}
+
+void parWaveStop(fp *f) {
+	unsigned int i;
+	struct parWaveStr *w = f->parWave;
+	w->done = 1;
+	pthread_barrier_wait(&w->bar);
+	for (i=1;i<w->jobs;i++) pthread_join(w->tid[i],NULL);
+	pthread_barrier_destroy(&w->bar);
+	for (i=0;i<w->jobs;i++) if (w->next[i] != NULL) safeFree(w->next[i]);
+	safeFree(w->finder);
+	safeFree(w->next);
+	safeFree(w->nextNum);
+	safeFree(w->nextCap);
+	safeFree(w->visit);
+	safeFree(w->thr);
+	safeFree(w->tid);
+	safeFree(w);
+	f->parWave = NULL;
+}
+
+int parWaveExpand(fp *f, unsigned int wireNum, unsigned int *targetX, unsigned int *targetY, unsigned int jobs) {
+	struct parWaveStr *w;
+	unsigned int cols=f->col;
+	unsigned int i, expVal;
+	gridInd finder, target;
+	int expandable = (f->curFrontNum > 0);
+
+	/* small foreheads are not worth the barriers */
+	if ( (jobs < 2) || (f->curFrontNum < PAR_FRONT) ) return fpWaveExpand(f,wireNum,targetX,targetY);
+	if (f->parWave == NULL) f->parWave = parWaveStart(f,jobs);
+	w = f->parWave;
+
+	/* expand a level by all threads */
+	w->wireNum  = wireNum;
+	w->front    = f->curFront;
+	w->frontNum = f->curFrontNum;
+	fpGrowFront(&f->nxtFront,&f->nxtFrontCap,4*f->curFrontNum);	/* each cell opens 4 neighbors at most */
+	expVal      = fpGetWaveValue(f,f->curFront[0]%f->col,f->curFront[0]/f->col);	/* level of the forehead */
+	pthread_barrier_wait(&w->bar);
+	parWaveLevel(w,0);
+	for (i=0,finder=GRID_NONE,f->nxtFrontNum=0;i<jobs;i++) {
+		finder = MIN(finder,w->finder[i]);
+		f->nxtFrontNum += w->nextNum[i];
+		f->visitCnt += w->visit[i];
+		w->visit[i] = 0;
+	}
+
+	if (finder != GRID_NONE) {
+		target = parTouchTarget(f,finder,wireNum);
+		*targetX = target%cols;
+		*targetY = target/cols;
+		fpSetWaveValue(f,*targetX,*targetY,expVal+1);
+		if (verbose) {printf("-I- Destination found at (%u,%u)\n",*targetX,*targetY);}
+		fpStep(steppingMode=='W',"Target found for source #%u",wireNum);
+	}
+
+	fpSwapFront(f);
+
+	/* if wave expansion mode and not found, print wave expansion message */
+	fpStep((steppingMode=='W') && (finder == GRID_NONE),"Wave expansion #%u from source #%u",expVal+1,wireNum);
+
+	if (finder != GRID_NONE) return 2;
+	return expandable;
+}
+
+/* infile parsing thread argument */
+struct parParseThread {
+	fp                 *f;        /* floorplan being parsed                                 */
+	struct fpScan       scan;     /* chunk of the infile                                    */
+	unsigned int        count;    /* pass 1: non-empty lines of the chunk                   */
+	unsigned int        lines;    /* pass 1: new lines of the chunk                         */
+	unsigned long long  first;    /* pass 2: index of the first non-empty line of the chunk */
+	unsigned int        blockNum; /* number of blockages                                    */
+	int                 pass;     /* 1: count lines, 2: parse                               */
+};
+
+/* count or parse the lines of one infile chunk */
+static void *parParseWorker(void *arg) {
+	struct parParseThread *t = (struct parParseThread*)arg;
+	if (t->pass == 1) t->count = fpScanCount(&t->scan,&t->lines);
+	else              fpParseLines(t->f,&t->scan,t->first,t->blockNum);
+	return NULL;
+}
+
+/* run pass of the parsing threads, thread 0 is the calling thread */
+static void parParsePass(struct parParseThread *thr, pthread_t *tid, unsigned int n, int pass) {
+	unsigned int i;
+	for (i=0;i<n;i++) thr[i].pass = pass;
+	for (i=1;i<n;i++) {
+		if (pthread_create(&tid[i],NULL,parParseWorker,&thr[i]) != 0) {
+			printf("-E- infile parsing thread creation failed! Exiting...\n");
+			exit(-1);
+		}
+	}
+	parParseWorker(&thr[0]);
+	for (i=1;i<n;i++) pthread_join(tid[i],NULL);
+}
+
+void parInfileParse(fp *f, struct fpScan *s, unsigned int blockNum, unsigned int jobs) {
+	struct parParseThread *thr;
+	pthread_t *tid;
+	struct fpScan w;
+	unsigned long long first=0, total;
+	unsigned int i, n, c, lineNum=s->lineNum;
+	unsigned int buf[1];
+	size_t len=s->end-s->p;
+	const char *p;
+
+	/* newline-aligned chunks of at least PAR_CHUNK bytes */
+	n = MIN(jobs,MAX(len/PAR_CHUNK,1));
+	thr = (struct parParseThread*)safeMalloc(sizeof(struct parParseThread)*n);
+	tid = (pthread_t*)safeMalloc(sizeof(pthread_t)*n);
+	p = s->p;
+	for (i=0;i<n;i++) {
+		thr[i].f          = f;
+		thr[i].blockNum   = blockNum;
+		thr[i].scan       = *s;
+		thr[i].scan.p     = p;
+		thr[i].scan.end   = (i == n-1) ? s->end : s->p+len/n*(i+1);
+		if (thr[i].scan.end < p) thr[i].scan.end = p;	/* previous chunk took a long line */
+		while ((thr[i].scan.end < s->end) && (thr[i].scan.end[-1] != '\n')) thr[i].scan.end++;
+		p = thr[i].scan.end;
+	}
+
+	/* pass 1: lines of each chunk, hence the line number and index of the first line of each chunk */
+	parParsePass(thr,tid,n,1);
+	for (i=0;i<n;i++) {
+		thr[i].scan.lineNum = lineNum;
+		thr[i].first        = first;
+		lineNum += thr[i].lines;
+		first   += thr[i].count;
+	}
+	total = first;
+	w = *s;
+	w.p       = s->end;
+	w.lineNum = lineNum;	/* end of the file, for missing lines */
+	if (total < blockNum)   fpScanError(&w,"Missing blockages");
+	if (total == blockNum)  fpScanError(&w,"Missing number of wires");
+
+	/* read number of wires: skip the blockage lines of its chunk */
+	for (c=0;thr[c].first+thr[c].count<=blockNum;c++);
+	w = thr[c].scan;
+	for (first=thr[c].first;fpScanLine(&w);first++) {
+		if (first == blockNum) break;
+		while ((w.p < w.end) && (*w.p != '\n')) w.p++;	/* blockage line, parsed in pass 2 */
+	}
+	if (fpScanRest(&w,buf,1) != 1) fpScanError(&w,"Should include one integer numbers");
+	fpCreateWires(f,buf[0]);
+	if (total < (unsigned long long)blockNum+1+f->wireNum) {
+		w = *s;
+		w.p       = s->end;
+		w.lineNum = lineNum;
+		fpScanError(&w,"Missing wires");
+	}
+
+	/* pass 2: parse the chunks in place */
+	parParsePass(thr,tid,n,2);
+	if (verbose) printf("-I- infile parsed by %u threads\n",n);
+	safeFree(thr);
+	safeFree(tid);
+}
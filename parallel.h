@@ -0,0 +1,83 @@
+/***********************************************************************************
+** Copyright (c) 2011, University of British Columbia (UBC); All rights reserved. **
+**                                                                                **
+** Redistribution  and  use  in  source   and  binary  forms,   with  or  without **
+** modification,  are permitted  provided that  the following conditions are met: **
+**   * Redistributions   of  source   code  must  retain   the   above  copyright **
+**     notice,  this   list   of   conditions   and   the  following  disclaimer. **
+**   * Redistributions  in  binary  form  must  reproduce  the  above   copyright **
+**     notice, this  list  of  conditions  and the  following  disclaimer in  the **
+**     documentation and/or  other  materials  provided  with  the  distribution. **
+**   * Neither the name of the University of British Columbia (UBC) nor the names **
+**     of   its   contributors  may  be  used  to  endorse  or   promote products **
+**     derived from  this  software without  specific  prior  written permission. **
+**                                                                                **
+** THIS  SOFTWARE IS  PROVIDED  BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" **
+** AND  ANY EXPRESS  OR IMPLIED WARRANTIES,  INCLUDING,  BUT NOT LIMITED TO,  THE **
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE **
+** DISCLAIMED.  IN NO  EVENT SHALL University of British Columbia (UBC) BE LIABLE **
+** FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL **
+** DAMAGES  (INCLUDING,  BUT NOT LIMITED TO,  PROCUREMENT OF  SUBSTITUTE GOODS OR **
+** SERVICES;  LOSS OF USE,  DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER **
+** CAUSED AND ON ANY THEORY OF LIABILITY,  WHETHER IN CONTRACT, STRICT LIABILITY, **
+** OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE **
+** OF  THIS SOFTWARE,  EVEN  IF  ADVISED  OF  THE  POSSIBILITY  OF  SUCH  DAMAGE. **
+***********************************************************************************/
+
+/***********************************************************************************
+** parallel.h: parallel routing of wires and parallel ripup blockage probes       **
+**                                                                                **
+**    Author: Ameer M. Abdelhadi (ameer@ece.ubc.ca, ameer.abdelhadi@gmail.com)    **
+**                University of British Columbia (UBC), Feb. 2011                 **
+***********************************************************************************/
+
+#ifndef __PARALLEL_HEADER__
+#define __PARALLEL_HEADER__
+
+#define PAR_MARGIN 8    /* routing region margin around the wire bounding box, unless -margin is set */
+#define PAR_TILE   16   /* side of the coarse tiles that mark the regions taken by a batch           */
+#define PAR_FRONT  1024 /* smaller wave foreheads are expanded by one thread (fpWaveExpand)          */
+#define PAR_CHUNK  4194304 /* infile bytes per parsing thread, smaller infiles by one thread         */
+
+/* route the wires of f->routeOrder by jobs threads, in batches of spatially disjoint wires: the  *
+ * routing region of a wire is the bounding box of its pins widened by a margin. wires are scanned *
+ * in routing order, a wire joins the batch if its region (plus one tile) does not overlap the     *
+ * region of an earlier scanned wire, hence overlapping wires keep their order. each thread routes *
+ * batch wires in its own view of f (fpRouteWireRegion). routed wires are moved to the front of    *
+ * f->routeOrder in routing order, wires that failed inside their region follow in their original *
+ * order. returns the number of routed wires. paths are shortest inside the regions and wires of  *
+ * later batches may be routed before earlier failed ones, hence the routed wires differ from the *
+ * sequential router (jobs 1); only the parallel search engine keeps its results                  */
+unsigned int parRouteDisjoint(fp *f, unsigned int jobs);
+
+/* route the wires of f->routeOrder speculatively by jobs threads: each round, the next ahead   *
+ * wires are routed at once, each thread routes in its own view holding a copy of the committed *
+ * grid. the routed trees are committed in routing order; a wire whose tree takes a tile        *
+ * claimed by an earlier commit of the round is routed again in the next round. routed wires    *
+ * are moved to the front of f->routeOrder in commit order, failed wires follow in their        *
+ * original order. returns the number of routed wires                                           */
+unsigned int parRouteSpeculative(fp *f, unsigned int jobs, unsigned int ahead);
+
+/* parallel fpFindBlockingWire: the blockage probes from the unrouted pins of wire #wireNum run   *
+ * on jobs threads with work stealing, each thread probes in its own view with private counters.  *
+ * results are merged in the row-major pin order of the sequential scan, including its early exit *
+ * at the first probe blocked by a single wire, hence the chosen wire is the same                 */
+unsigned int parFindBlockingWire(fp *f, unsigned int wireNum, unsigned int jobs);
+
+/* frontier-parallel Lee-Moore wave expansion (search mode 'P'), a level-synchronous fpWaveExpand: *
+ * jobs threads split the forehead, claim its empty unvisited neighbors by a compare-and-swap on    *
+ * their wave tags and collect them in own buffers, concatenated into the new forehead. wave       *
+ * values, wave types and the found target are the same as of fpWaveExpand. threads are started on *
+ * first use and wait between levels until parWaveStop. returns as fpWaveExpand                    */
+int parWaveExpand(fp *f, unsigned int wireNum, unsigned int *targetX, unsigned int *targetY, unsigned int jobs);
+
+/* stop the wave search threads of floorplan f (f->parWave) */
+void parWaveStop(fp *f);
+
+/* parse the blockage and wire lines of infile scan s into f by up to jobs threads, s starts    *
+ * after the number of blockages line. s is split into newline-aligned chunks; a first pass     *
+ * counts the lines of each chunk, hence each thread knows the blockage or wire index of its    *
+ * first line, then the number of wires is read and the chunks are parsed in place (fpParseLines) */
+void parInfileParse(fp *f, struct fpScan *s, unsigned int blockNum, unsigned int jobs);
+
+#endif /* __PARALLEL_HEADER__ */